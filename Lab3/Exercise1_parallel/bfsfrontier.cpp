@@ -0,0 +1,114 @@
+#include <stdlib.h>
+
+#include <string>
+#include <iostream>
+
+#include "confno.h"
+#include "bfsfrontier.h"
+
+using namespace std;
+
+/**
+ * Frontier of a breadth first search without predecessor information: a queue containing
+ * just the configuration numbers of the current tree depth (read queue) and of the next tree
+ * depth (write queue).
+ */
+
+
+/**
+ * Constructor: Create a frontier for configuration numbers between 0 and numConf-1.
+ */
+BFSFrontier::BFSFrontier(confno_t numConf)
+{
+	queue_length = qIndex1(((numConf < MAXLENGTH) ? (unsigned long)numConf : MAXLENGTH) - 1) + 1;
+	queue[0] = new confno_t *[queue_length]();
+	queue[1] = new confno_t *[queue_length]();
+	wrPos = 0;
+	rdLength = 0;
+	depth = 0;
+}
+
+/**
+ * Destructor: deallocate memory.
+ */
+BFSFrontier::~BFSFrontier()
+{
+	for (unsigned int i=0; i<queue_length; i++) {
+		delete[] queue[0][i];
+		delete[] queue[1][i];
+	}
+	delete[] queue[0];
+	delete[] queue[1];
+}
+
+/**
+ * Increase the tree depth by one. The previous write queue becomes the read queue for the
+ * new tree depth; the old read queue is discarded.
+ */
+void BFSFrontier::pushDepth()
+{
+	depth++;
+	rdLength = wrPos;
+	wrPos = 0;
+}
+
+/**
+ * Append the configuration 'conf' to the write queue. This method is thread-safe and
+ * lock-free (the slot in the write queue is reserved with an atomic fetch-and-add).
+ */
+void BFSFrontier::add(confno_t conf)
+{
+	unsigned long pos = __sync_fetch_and_add(&wrPos, 1);
+	getQueueBlock(depth % 2, qIndex1(pos))[qIndex2(pos)] = conf;
+}
+
+/**
+ * Return the second-level array with index 'n1' of queue 'wr'. If necessary, the array is
+ * allocated and installed with an atomic compare-and-swap.
+ */
+confno_t * BFSFrontier::getQueueBlock(unsigned int wr, unsigned int n1)
+{
+	confno_t * block = queue[wr][n1];
+	if (block == NULL) {
+		confno_t * newBlock = new confno_t[BLOCKSIZE];
+		if (__sync_bool_compare_and_swap(&queue[wr][n1], (confno_t *)NULL, newBlock)) {
+			block = newBlock;
+		}
+		else {
+			delete[] newBlock;
+			block = queue[wr][n1];
+		}
+	}
+	return block;
+}
+
+/**
+ * Return the length of the read queue.
+ */
+unsigned int BFSFrontier::length()
+{
+	return rdLength;
+}
+
+/**
+ * Return the i-th entry in the read queue.
+ */
+confno_t BFSFrontier::get(unsigned int i)
+{
+	return queue[(depth-1) % 2][qIndex1(i)][qIndex2(i)];
+}
+
+/**
+ * Return the number of KBytes used by the queues.
+ */
+unsigned long BFSFrontier::memory()
+{
+	unsigned long size = 2*queue_length*sizeof(confno_t *)/1024;
+	for (unsigned int i=0; i<queue_length; i++) {
+		if (queue[0][i] != NULL)
+			size += BLOCKSIZE/1024*sizeof(confno_t);
+		if (queue[1][i] != NULL)
+			size += BLOCKSIZE/1024*sizeof(confno_t);
+	}
+	return size;
+}
@@ -0,0 +1,82 @@
+using namespace std;
+
+/**
+ * Frontier of a breadth first search without predecessor information: a queue containing
+ * just the configuration numbers of the current tree depth (read queue) and of the next tree
+ * depth (write queue). In contrast to BFSQueue, the tree depths that have been examined are not
+ * kept at all; the solution path is determined from a DFSDepthMap instead (see
+ * doPredecessorFreeBreadthFirstSearch()).
+ */
+class BFSFrontier
+{
+ private:
+	// Split queue, see BFSQueue. When processing tree depth X, the configurations of depth
+	// X-1 are read from queue[(X-1)%2], and those of depth X are written into queue[X%2].
+	confno_t * volatile * queue[2];
+
+	// Number of entries in queue[0] and queue[1], respectively
+	unsigned int queue_length;
+
+	// Position of the next free entry in the write queue
+	volatile unsigned long wrPos;
+
+	// Length of the read queue
+	unsigned int rdLength;
+
+	// Current tree depth
+	unsigned int depth;
+
+	// The queues are allocated block by block, exactly like in BFSQueue.
+	static const unsigned int BLOCKBITS = 16;                 // 16 Bit, arrays with 65536 entries
+	static const unsigned int BLOCKSIZE = (1<<BLOCKBITS);     // Block size for allocation: 2^16
+	static const unsigned int BLOCKMASK = ((1<<BLOCKBITS)-1); // Bit mask where the last 16 bits
+	                                                          // are set
+
+	inline unsigned int qIndex1(unsigned long i)  { return i >> BLOCKBITS; }
+	inline unsigned int qIndex2(unsigned long i)  { return i & BLOCKMASK; }
+
+	// Maximum number of entries in a queue (the positions in the read queue are unsigned int's)
+	static const unsigned long MAXLENGTH = 1UL << 32;
+
+	// Return the second-level array with index 'n1' of queue 'wr'. If necessary, the array is
+	// allocated and installed with an atomic compare-and-swap.
+	confno_t * getQueueBlock(unsigned int wr, unsigned int n1);
+
+ public:
+	/**
+	 * Constructor: Create a frontier for configuration numbers between 0 and numConf-1.
+	 */
+	BFSFrontier(confno_t numConf);
+
+	/**
+	 * Destructor: deallocate memory.
+	 */
+	~BFSFrontier();
+
+	/**
+	 * Increase the tree depth by one. The previous write queue becomes the read queue for the
+	 * new tree depth; the old read queue is discarded.
+	 */
+	void pushDepth();
+
+	/**
+	 * Append the configuration 'conf' to the write queue. This method is thread-safe and
+	 * lock-free (the slot in the write queue is reserved with an atomic fetch-and-add).
+	 */
+	void add(confno_t conf);
+
+	/**
+	 * Return the length of the read queue.
+	 */
+	unsigned int length();
+
+	/**
+	 * Return the i-th entry in the read queue.
+	 */
+	confno_t get(unsigned int i);
+
+	/**
+	 * Return the number of KBytes used by the queues.
+	 */
+	unsigned long memory();
+};
@@ -1,14 +1,26 @@
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <pthread.h>
 
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
+#include "confno.h"
+#include "confighashmap.h"
+#include "historyfile.h"
+#include "mappedarray.h"
 #include "bfsqueue.h"
 
 using namespace std;
 
+bool BFSQueue::compressHistory = false;
+
 /**
  * Data structure for supporting the breadth first search. The data structure primarily implements
  * a queue for configurations, connected with a set (bit set) storing the configurations that have
@@ -18,30 +30,91 @@ using namespace std;
 
 /**
  * Constructor: Create a queue/bit set for configuration numbers between
- * 0 and numConf-1.
+ * 0 and numConf-1, and 'nBox' boxes.
  */
-BFSQueue::BFSQueue(unsigned long numConf)
-	: file("sokoban.tmp", ios::out|ios::in|ios::trunc|ios::binary) // open a temporary file
+BFSQueue::BFSQueue(confno_t numConf, unsigned int nBox)
+	: file("sokoban.tmp") // open a temporary file
 {
-	if (!file.is_open()) {
-		cerr << "Cannot open tmp file 'sokoban.tmp'\n";
+	init(numConf, nBox);
+}
+
+// Create the directory 'dir' (if necessary) and return the name of the swap file in it. If
+// the search does not resume, the files of an old checkpoint in 'dir' are deleted first:
+// checkpoint() only writes the blocks of the bit sets changed since the last checkpoint, so
+// stale blocks of an earlier search would otherwise become part of the new checkpoints.
+static string historyFileIn(const char * dir, bool resume)
+{
+	mkdir(dir, 0700);
+	string d(dir);
+	if (!resume) {
+		unlink((d + "/state").c_str());
+		unlink((d + "/bitset0").c_str());
+		unlink((d + "/bitset1").c_str());
+		unlink((d + "/history").c_str());
+	}
+	return d + "/history";
+}
+
+/**
+ * Constructor: Create a queue/bit set like above, which writes checkpoints into the
+ * directory 'dir' (see checkpoint()). If 'resume' is true, the search continues with
+ * the last checkpoint in this directory.
+ */
+BFSQueue::BFSQueue(confno_t numConf, unsigned int nBox, const char * dir, bool resume)
+	: file(historyFileIn(dir, resume).c_str(), true) // keep the swap file
+{
+	init(numConf, nBox);
+	if (hashed != NULL) {
+		cerr << "Error: checkpoints need a bit set, but the configuration numbers are too large\n";
+		exit(1);
+	}
+	if (compressHistory) {
+		cerr << "Error: checkpoints cannot be combined with a compressed swap file\n";
 		exit(1);
 	}
-	// Delete the file. However, it stays accessible until it is closed.
-	// When using the Windows OS, you may need to delete this statement.
-	unlink("sokoban.tmp");
+	checkpointDir = dir;
+	modified = new volatile int[bitset_length];
+	for (unsigned int i=0; i<bitset_length; i++)
+		modified[i] = -1;
+	lastWritten[0] = lastWritten[1] = 0;
+	if (resume)
+		this->resume();
+}
 
+/**
+ * Initialize the queue/bit set for configuration numbers between 0 and numConf-1, and
+ * 'nBox' boxes (used by the constructors).
+ */
+void BFSQueue::init(confno_t numConf, unsigned int nBox)
+{
 	// Allocate arrays and initialize them with NULL. This initialization is caused by the
 	// empty pair of parentheses () at the end of the 'new' operator.
-	queue_length = qIndex1(numConf-1) + 1;
-	queue[0] = new Entry *[queue_length]();
-	queue[1] = new Entry *[queue_length]();
-	bitset_length = bsIndex1(numConf-1) + 1;
-	bitset = new volatile unsigned int*[bitset_length]();
+	queue_length = qIndex1(((numConf < MAXLENGTH) ? (unsigned long)numConf : MAXLENGTH) - 1) + 1;
+	queue[0] = new char *[queue_length]();
+	queue[1] = new char *[queue_length]();
+	configBits = (numConf > 1) ? highestBit(numConf-1) + 1 : 1;
+	boxBits = (nBox > 1) ? highestBit(nBox-1) + 1 : 0;
+	format[0] = makeFormat(0);
+	format[1] = makeFormat(0);
+	// The bit set needs numConf/8 bytes in the worst case. If this does not fit into the
+	// main memory, use a hash map instead.
+	if (ConfigHashMap::fitsDense(numConf / 8)) {
+		bitset_length = bsBlock(numConf-1) + 1;
+		bitsetMap = new MappedArray((unsigned long)bitset_length * BLOCKSIZE * sizeof(unsigned int));
+		bitset = (volatile unsigned int *)bitsetMap->data();
+		hashed = NULL;
+	}
+	else {
+		bitset_length = 0;
+		bitsetMap = NULL;
+		bitset = NULL;
+		hashed = new ConfigHashMap();
+	}
 	wrPos = 0;
 	rdLength = 0;
 	depth = 0;
-	file_length = 0;
+	modified = NULL;
+	writing = false;
 }
 
 /**
@@ -49,17 +122,16 @@ BFSQueue::BFSQueue(unsigned long numConf)
  */
 BFSQueue::~BFSQueue()
 {
+	waitForExport();
 	for (unsigned int i=0; i<queue_length; i++) {
 		delete[] queue[0][i];
 		delete[] queue[1][i];
 	}
-	for (unsigned int i=0; i<bitset_length; i++) {
-		delete[] bitset[i];
-	}
 	delete[] queue[0];
 	delete[] queue[1];
-	delete[] bitset;
-	file.close();
+	delete bitsetMap;
+	delete hashed;
+	delete[] modified;
 }
 
 /**
@@ -69,64 +141,256 @@ BFSQueue::~BFSQueue()
  */
 void BFSQueue::pushDepth()
 {
-	unsigned int wr = depth % 2;
-	unsigned int n1 = qIndex1(wrPos);
-	unsigned int n2 = qIndex2(wrPos);
+	// The previous export must be complete: its queue becomes the new write queue
+	waitForExport();
 
-	// Export the old read queue to a file.
-	for (unsigned int i=0; i<n1; i++)
-		file.write((char *)queue[wr][i], BLOCKSIZE * sizeof(Entry));
-	if (n2 > 0)
-		file.write((char *)queue[wr][n1], n2 * sizeof(Entry));
-	file_length += ((unsigned long)BLOCKSIZE) * n1 + n2;
+	// Export the old read queue to a file in the background. If no thread can be
+	// created, it is exported directly.
+	unsigned int wr = depth % 2;
+	layerStart.push_back(file.length());
+	layerFormat.push_back(format[wr]);
+	exportQueue = wr;
+	exportLength = wrPos;
+	exportFormat = format[wr];
+	writing = (pthread_create(&writer, NULL, runExport, this) == 0);
+	if (!writing)
+		exportLayer();
 
 	depth++;
 	rdLength = wrPos;
 	wrPos = 0;
+
+	// Determine the format of the new write queue. If the size of its entries changes,
+	// its second-level arrays must be allocated anew.
+	wr = depth % 2;
+	Format f = makeFormat(rdLength);
+	if (f.size != format[wr].size) {
+		for (unsigned int i=0; i<queue_length; i++) {
+			delete[] queue[wr][i];
+			queue[wr][i] = NULL;
+		}
+	}
+	format[wr] = f;
+}
+
+/**
+ * Write the queue given by exportQueue/exportLength/exportFormat to the swap file.
+ */
+void BFSQueue::exportLayer()
+{
+	if (compressHistory) {
+		layerBlock.push_back(blockStart.size());
+		unsigned char * buf = new unsigned char[MAXVARINT * (3 * BLOCKSIZE + 1)];
+		for (unsigned long pos=0; pos<exportLength; pos+=BLOCKSIZE) {
+			unsigned long n = (exportLength - pos < BLOCKSIZE) ? exportLength - pos : BLOCKSIZE;
+			blockStart.push_back(file.length());
+			file.append(buf, encodeBlock(queue[exportQueue][qIndex1(pos)], n, exportFormat, buf));
+		}
+		delete[] buf;
+		return;
+	}
+	unsigned int n1 = qIndex1(exportLength);
+	unsigned int n2 = qIndex2(exportLength);
+	unsigned int size = exportFormat.size;
+	for (unsigned int i=0; i<n1; i++)
+		file.append(queue[exportQueue][i], BLOCKSIZE * size);
+	if (n2 > 0)
+		file.append(queue[exportQueue][n1], n2 * size);
+}
+
+void * BFSQueue::runExport(void * queue)
+{
+	((BFSQueue *)queue)->exportLayer();
+	return NULL;
+}
+
+/**
+ * Wait until the export in progress (if any) is complete. The swap file may only be
+ * accessed after this.
+ */
+void BFSQueue::waitForExport()
+{
+	if (writing) {
+		pthread_join(writer, NULL);
+		writing = false;
+	}
+}
+
+// Store 'v' as variable-length integer at 'p' (7 bits per byte, lowest bits first; the
+// highest bit is set in all but the last byte). Returns the position behind it.
+static inline unsigned char * putVarint(unsigned char * p, confno_t v)
+{
+	while (v >= 128) {
+		*p++ = (unsigned char)v | 128;
+		v >>= 7;
+	}
+	*p++ = (unsigned char)v;
+	return p;
+}
+
+// Load a variable-length integer from 'p' into '*v'. Returns the position behind it.
+static inline const unsigned char * getVarint(const unsigned char * p, confno_t * v)
+{
+	confno_t r = 0;
+	unsigned int shift = 0;
+	while (*p >= 128) {
+		r |= (confno_t)(*p++ & 127) << shift;
+		shift += 7;
+	}
+	*v = r | ((confno_t)*p++ << shift);
+	return p;
+}
+
+// Map the difference 'cur'-'prev' to an unsigned value that is small for small positive
+// and negative differences (0, -1, 1, -2, 2, ... become 0, 1, 2, 3, 4, ...), and back.
+static inline confno_t zigzag(confno_t cur, confno_t prev)
+{
+	confno_t d = cur - prev;
+	return (d << 1) ^ ((confno_t)0 - (d >> (sizeof(confno_t) * 8 - 1)));
+}
+
+static inline confno_t unzigzag(confno_t z, confno_t prev)
+{
+	return prev + ((z >> 1) ^ ((confno_t)0 - (z & 1)));
+}
+
+/**
+ * Compress the first 'n' entries of 'block' (in the format 'f') into 'buf' and return the
+ * number of bytes.
+ */
+unsigned long BFSQueue::encodeBlock(const char * block, unsigned long n, const Format & f,
+									unsigned char * buf)
+{
+	unsigned char * p = buf;
+	confno_t lastConf = 0;
+	unsigned int lastPred = 0;
+	for (unsigned long i=0; i<n; i++) {
+		unsigned int pred, box;
+		confno_t conf = f.read(block, i, &pred, &box);
+		p = putVarint(p, zigzag(conf, lastConf));
+		p = putVarint(p, zigzag(pred, lastPred));
+		p = putVarint(p, box);
+		lastConf = conf;
+		lastPred = pred;
+	}
+	return p - buf;
+}
+
+/**
+ * Return the entry at index 'n2' of a block compressed by encodeBlock() (configuration as
+ * return value, predecessor index in *pred).
+ */
+confno_t BFSQueue::decodeEntry(const unsigned char * buf, unsigned long n2, unsigned int * pred)
+{
+	const unsigned char * p = buf;
+	confno_t conf = 0;
+	confno_t prd = 0;
+	for (unsigned long i=0; i<=n2; i++) {
+		confno_t v;
+		p = getVarint(p, &v);
+		conf = unzigzag(v, conf);
+		p = getVarint(p, &v);
+		prd = unzigzag(v, prd);
+		p = getVarint(p, &v);   // box number (not needed)
+	}
+	*pred = (unsigned int)prd;
+	return conf;
+}
+
+/**
+ * Determine the format of the entries whose predecessors are in a queue of length
+ * 'predLength'.
+ */
+BFSQueue::Format BFSQueue::makeFormat(unsigned int predLength)
+{
+	Format f;
+	unsigned int predBits = (predLength > 1) ? highestBit(predLength-1) + 1 : 0;
+	f.packed = (configBits + predBits + boxBits <= 64);
+	if (f.packed) {
+		f.size = sizeof(unsigned long);
+		f.predShift = configBits;
+		// Without box bits, the shift could be 64, which is undefined
+		f.boxShift = (boxBits != 0) ? configBits + predBits : 0;
+		f.predMask = (1UL << predBits) - 1;
+	}
+	else {
+		f.size = sizeof(Entry);
+		f.predShift = 0;
+		f.boxShift = 0;
+		f.predMask = -1;
+	}
+	return f;
 }
 
 /**
  * Checks if the given configuration is already contained in the bit set. If not, the
  * configuration is entered in the bit set and the configuration, the index of the predecessor
  * configuration and the number of the moved box are added to the write queue.
+ * This method is thread-safe and lock-free: the bit is set with an atomic fetch-and-or,
+ * and the slot in the write queue is reserved with an atomic fetch-and-add.
  */
-bool BFSQueue::lookup_and_add(unsigned long conf, unsigned int predIndex, unsigned int box)
+bool BFSQueue::lookup_and_add(confno_t conf, unsigned int predIndex, unsigned int box)
 {
-	unsigned int bitmask = 1 << bsBitPos(conf);
-	unsigned int i1 = bsIndex1(conf);
-	unsigned int i2 = bsIndex2(conf);
-
-	// If necessary, allocate an array at the second level and initialize it with 0
-	if (bitset[i1] == NULL)
-		bitset[i1] = new unsigned int[BLOCKSIZE]();
+	if (hashed != NULL) {
+		// If the configuration is in the hash map: we are done. Otherwise it is entered.
+		if (!hashed->lookup_and_set(conf, 1, NULL))
+			return false;
+	}
+	else {
+		unsigned int bitmask = 1 << bsBitPos(conf);
+		volatile unsigned int * word = &bitset[bsIndex(conf)];
 
-	// If the configuration is in the bit set: we are done
-	if ((bitset[i1][i2] & bitmask) != 0)
-		return false;
+		// If the configuration is in the bit set: we are done. This plain read avoids the
+		// (more expensive) atomic operation for all configurations that have been visited
+		// before, which is the common case.
+		if ((*word & bitmask) != 0)
+			return false;
 
-	// add the configuration to the bit set
-	bitset[i1][i2] |= bitmask;
+		// Add the configuration to the bit set. If another thread has set the bit in the
+		// meantime, that thread is responsible for adding the configuration to the queue.
+		if ((__sync_fetch_and_or(word, bitmask) & bitmask) != 0)
+			return false;
+		if (modified != NULL)
+			modified[bsBlock(conf)] = depth;
+	}
 
 	// Append the configuration, the index of the predecessor configuration and the
 	// number of the moved box at the end of the write queue.
 
 	unsigned int wr = depth % 2;
-	unsigned int n1 = qIndex1(wrPos);
-	unsigned int n2 = qIndex2(wrPos);
+	unsigned long pos = __sync_fetch_and_add(&wrPos, 1);  // Reserve a slot
+	unsigned int n1 = qIndex1(pos);
+	unsigned int n2 = qIndex2(pos);
 
 	// If necessary, allocate an array at the second level and initialize it
-	if (queue[wr][n1] == NULL)
-		queue[wr][n1] = new Entry[BLOCKSIZE]();
+	volatile char * entries = getQueueBlock(wr, n1);
 
-	// Write the new entry at position wrPos into the write queue
-	queue[wr][n1][n2].set(conf, wrPos + (rdLength - predIndex), box);
-
-	// Increment the write position
-	wrPos++;
+	// Write the new entry at position pos into the write queue
+	format[wr].write(entries, n2, conf, predIndex, box);
 
 	return true;
 }
 
+/**
+ * Return the second-level array with index 'n1' of queue 'wr'. If necessary, the array is
+ * allocated, initialized and installed with an atomic compare-and-swap.
+ */
+volatile char * BFSQueue::getQueueBlock(unsigned int wr, unsigned int n1)
+{
+	char * block = queue[wr][n1];
+	if (block == NULL) {
+		char * newBlock = new char[BLOCKSIZE * format[wr].size]();
+		if (__sync_bool_compare_and_swap(&queue[wr][n1], (char *)NULL, newBlock)) {
+			block = newBlock;
+		}
+		else {
+			delete[] newBlock;
+			block = queue[wr][n1];
+		}
+	}
+	return block;
+}
+
 /**
  * Return the length of the read queue.
  */
@@ -139,13 +403,10 @@ unsigned int BFSQueue::length()
  * Return the i-th entry in the read queue (configuration as return value;
  * moved box in *box).
  */
-unsigned long BFSQueue::get(unsigned int i, unsigned int * box)
+confno_t BFSQueue::get(unsigned int i, unsigned int * box)
 {
 	unsigned int rd = (depth-1) % 2;
-	Entry *e = &queue[rd][qIndex1(i)][qIndex2(i)];
-	if (box != NULL)
-		*box = e->box;
-	return e->config;
+	return format[rd].read(queue[rd][qIndex1(i)], qIndex2(i), NULL, box);
 }
 
 /**
@@ -154,48 +415,207 @@ unsigned long BFSQueue::get(unsigned int i, unsigned int * box)
  * the length of the path is returned. The result is allocated dynamically and should be
  * deallocated using delete[].
  */
-unsigned long * BFSQueue::getPath(unsigned long conf, unsigned int predIndex,
+confno_t * BFSQueue::getPath(confno_t conf, unsigned int predIndex,
 								  unsigned int * path_length)
 {
-	unsigned long * path = new unsigned long[depth+1];
+	confno_t * path = new confno_t[depth+1];
 	path[depth] = conf;
-	unsigned int pos = rdLength - predIndex - 1;
-	long abspos = file_length * sizeof(Entry); // XX
+	unsigned int pos = predIndex;
+	waitForExport();
 
 	// Iterate the path in reversed order
 	for (int k = depth-1; k>=0; k--) {
-		Entry e;
-		// Search the entry for the predecessor configuration in the file and load it
-		file.seekg(-((int)pos+1)*sizeof(Entry), ios::cur);
-		file.read((char *)&e, sizeof(Entry));
-		path[k] = e.config;
-		pos = e.pred;
+		// Load the entry for the predecessor configuration from the file. If the file is
+		// compressed, only the block containing the entry is decompressed.
+		if (compressHistory) {
+			unsigned long b = layerBlock[k] + qIndex1(pos);
+			path[k] = decodeEntry((const unsigned char *)file.at(blockStart[b]), qIndex2(pos), &pos);
+			continue;
+		}
+		const char * layer = (const char *)file.at(layerStart[k]);
+		path[k] = layerFormat[k].read(layer, pos, &pos, NULL);
 	}
 	*path_length = depth+1;
 	return path;
 }
 
+/**
+ * Return the current tree depth (i.e., the number of calls of pushDepth()).
+ */
+unsigned int BFSQueue::getDepth()
+{
+	return depth;
+}
+
+/**
+ * Return the name of the file 'name' in the checkpoint directory.
+ */
+string BFSQueue::checkpointFile(const char * name)
+{
+	return checkpointDir + "/" + name;
+}
+
+/**
+ * Write a checkpoint for the current tree depth, which must be called directly after
+ * pushDepth(). All data is written to the disk before the checkpoint is made valid, so a
+ * crash while writing leaves the previous checkpoint intact.
+ */
+void BFSQueue::checkpoint()
+{
+	// (1) Write the blocks of the bit set changed since the last checkpoint in the copy
+	// which is not used by the current checkpoint. The file is sparse, blocks that were
+	// never changed are not written.
+	unsigned int copy = depth % 2;
+	string name = checkpointFile(copy ? "bitset1" : "bitset0");
+	int fd = open(name.c_str(), O_RDWR|O_CREAT, 0600);
+	if (fd < 0) {
+		cerr << "Cannot open checkpoint file '" << name << "'\n";
+		exit(1);
+	}
+	unsigned long blockBytes = BLOCKSIZE * sizeof(unsigned int);
+	for (unsigned int i=0; i<bitset_length; i++) {
+		if (modified[i] < (int)lastWritten[copy])
+			continue;
+		const void * block = (const void *)&bitset[(unsigned long)i * BLOCKSIZE];
+		if (pwrite(fd, block, blockBytes, i * blockBytes) != (ssize_t)blockBytes) {
+			cerr << "Cannot write checkpoint file '" << name << "'\n";
+			exit(1);
+		}
+	}
+	fsync(fd);
+	close(fd);
+
+	// (2) Write the swap file, which contains the current read queue as its last layer. Its
+	// export runs in the background while the bit set is written.
+	waitForExport();
+	file.sync();
+
+	// (3) Write the new state and replace the old one
+	string tmp = checkpointFile("state.tmp");
+	{
+		ofstream out(tmp.c_str());
+		out << "sokoban-checkpoint " << bitset_length << " " << configBits << " " << boxBits
+			<< " " << depth << " " << rdLength << " " << file.length() << " " << copy << " "
+			<< lastWritten[1-copy] << " " << layerStart.size() << "\n";
+		for (unsigned int k=0; k<layerStart.size(); k++) {
+			const Format & f = layerFormat[k];
+			out << layerStart[k] << " " << f.packed << " " << f.size << " " << f.predShift << " "
+				<< f.boxShift << " " << f.predMask << "\n";
+		}
+		if (!out) {
+			cerr << "Cannot write checkpoint file '" << tmp << "'\n";
+			exit(1);
+		}
+	}
+	fd = open(tmp.c_str(), O_RDONLY);
+	fsync(fd);
+	close(fd);
+	if (rename(tmp.c_str(), checkpointFile("state").c_str()) != 0) {
+		cerr << "Cannot write checkpoint file '" << checkpointFile("state") << "'\n";
+		exit(1);
+	}
+	lastWritten[copy] = depth;
+}
+
+/**
+ * Continue with the last checkpoint in the checkpoint directory.
+ */
+void BFSQueue::resume()
+{
+	// Read the state
+	string name = checkpointFile("state");
+	ifstream in(name.c_str());
+	string magic;
+	unsigned int length, cBits, bBits, copy, other;
+	unsigned long fileLength, nLayers;
+	if (!(in >> magic >> length >> cBits >> bBits >> depth >> rdLength >> fileLength >> copy
+		  >> other >> nLayers) || (magic != "sokoban-checkpoint")) {
+		cerr << "Error: no checkpoint in '" << checkpointDir << "'\n";
+		exit(1);
+	}
+	if ((length != bitset_length) || (cBits != configBits) || (bBits != boxBits)) {
+		cerr << "Error: the checkpoint in '" << checkpointDir << "' belongs to another level\n";
+		exit(1);
+	}
+	for (unsigned long k=0; k<nLayers; k++) {
+		unsigned long start;
+		Format f;
+		if (!(in >> start >> f.packed >> f.size >> f.predShift >> f.boxShift >> f.predMask)) {
+			cerr << "Error: invalid checkpoint file '" << name << "'\n";
+			exit(1);
+		}
+		layerStart.push_back(start);
+		layerFormat.push_back(f);
+	}
+	lastWritten[copy] = depth;
+	lastWritten[1-copy] = other;
+
+	// Read the bit set. Blocks containing only zeros are skipped, so their pages are not
+	// allocated. Since the blocks are
+	// not contained in the other copy of the bit set, they count as changed in the previous
+	// tree depth.
+	name = checkpointFile(copy ? "bitset1" : "bitset0");
+	int fd = open(name.c_str(), O_RDONLY);
+	if (fd < 0) {
+		cerr << "Cannot open checkpoint file '" << name << "'\n";
+		exit(1);
+	}
+	unsigned long blockBytes = BLOCKSIZE * sizeof(unsigned int);
+	unsigned int * block = new unsigned int[BLOCKSIZE];
+	for (unsigned int i=0; i<bitset_length; i++) {
+		ssize_t n = pread(fd, block, blockBytes, i * blockBytes);
+		if (n <= 0)
+			break;
+		memset((char *)block + n, 0, blockBytes - n);
+		bool empty = true;
+		for (unsigned int j=0; (j<BLOCKSIZE) && empty; j++)
+			empty = (block[j] == 0);
+		if (empty)
+			continue;
+		memcpy((void *)&bitset[(unsigned long)i * BLOCKSIZE], block, blockBytes);
+		modified[i] = depth - 1;
+	}
+	delete[] block;
+	close(fd);
+
+	// Reload the read queue from the last layer of the swap file, and determine the format
+	// of the write queue
+	file.resume(fileLength);
+	unsigned int rd = (depth-1) % 2;
+	format[rd] = layerFormat.back();
+	const char * layer = (const char *)file.at(layerStart.back());
+	for (unsigned long pos=0; pos<rdLength; pos+=BLOCKSIZE) {
+		unsigned long n = (rdLength - pos < BLOCKSIZE) ? rdLength - pos : BLOCKSIZE;
+		queue[rd][qIndex1(pos)] = new char[BLOCKSIZE * format[rd].size]();
+		memcpy(queue[rd][qIndex1(pos)], layer + pos * format[rd].size, n * format[rd].size);
+	}
+	format[depth % 2] = makeFormat(rdLength);
+	wrPos = 0;
+}
+
 /**
  * Returns information about RAM and hard disk usage.
  */
 void BFSQueue::statistics()
 {
-	unsigned int size = 2*queue_length*sizeof(Entry *)/1024;
+	unsigned int size = 2*queue_length*sizeof(char *)/1024;
 	for (unsigned int i=0; i<queue_length; i++) {
 		if (queue[0][i] != NULL)
-			size += BLOCKSIZE/1024*sizeof(Entry);
+			size += BLOCKSIZE/1024*format[0].size;
 		if (queue[1][i] != NULL)
-			size += BLOCKSIZE/1024*sizeof(Entry);
+			size += BLOCKSIZE/1024*format[1].size;
 	}
 	cout << "Used " << size << " KBytes for arrays\n";
 
-	size = bitset_length*sizeof(unsigned int *)/1024;
-	for (unsigned int i=0; i<bitset_length; i++) {
-		if (bitset[i] != NULL)
-			size += BLOCKSIZE/1024*sizeof(unsigned int);
+	if (hashed != NULL) {
+		cout << "Used " << hashed->memory() << " KBytes for hash map ("
+			 << hashed->entries() << " configurations)\n";
+	}
+	else {
+		cout << "Used " << bitsetMap->resident() << " KBytes for bit set\n";
 	}
-	cout << "Used " << size << " KBytes for bit set\n";
 
-	size = file_length*sizeof(Entry)/1024;
+	waitForExport();
+	size = file.length()/1024;
 	cout << "Used " << size << " KBytes for temp file\n";
 }
@@ -11,28 +11,83 @@ class BFSQueue
 	/*
 	 * Class for an entry in the queue. Each entry contains:
 	 * - the number of the configuration
-	 * - the relative position of the predecessor configuration in the queue
+	 * - the index of the predecessor configuration in the queue of the previous tree depth
 	 *   (this is needed to determine the solution path when a solution has been found)
 	 * - the number of the box that was moved to reach this configuration
 	 *   (this is used to preferrably move the same box with the next move)
 	 */
 	class Entry {
 	public:
-		unsigned long config;
+		confno_t config;
 		unsigned int pred;
 		unsigned int box;
 		
-		inline void set(unsigned long aconfig, unsigned int apred, unsigned int abox) volatile {
+		inline void set(confno_t aconfig, unsigned int apred, unsigned int abox) volatile {
 			config = aconfig;
 			pred = apred;
 			box = abox;
 		}
 	};
 
+	/*
+	 * Format of the entries of one tree depth. If the configuration number, the index of the
+	 * predecessor and the box number fit into 64 bits together, each entry is packed into a
+	 * single unsigned long: the configuration number in the lowest bits, followed by the
+	 * index of the predecessor and the box number. Otherwise, an Entry is used. Since the
+	 * index of the predecessor is less than the length of the previous tree depth, the format
+	 * is determined anew for each tree depth.
+	 */
+	class Format {
+	public:
+		bool packed;                // Packed entries?
+		unsigned int size;          // Size of an entry in bytes
+		unsigned int predShift;     // Position of the predecessor index in a packed entry
+		unsigned int boxShift;      // Position of the box number in a packed entry (0 if there
+		                            // is only one box, i.e., the box number is not stored)
+		unsigned long predMask;     // Mask for the predecessor index (before shifting)
+
+		// Store an entry at index 'n2' of 'block'.
+		inline void write(volatile char * block, unsigned int n2, confno_t conf,
+						  unsigned int pred, unsigned int box) const {
+			if (packed)
+				((volatile unsigned long *)block)[n2] = (unsigned long)conf
+					| ((pred & predMask) << predShift) | ((unsigned long)box << boxShift);
+			else
+				((volatile Entry *)block)[n2].set(conf, pred, box);
+		}
+
+		// Load the entry at index 'n2' of 'block'. The configuration number is returned,
+		// the predecessor index and the box number in *pred and *box (if not NULL).
+		inline confno_t read(const char * block, unsigned long n2, unsigned int * pred,
+							 unsigned int * box) const {
+			if (packed) {
+				unsigned long e = ((const unsigned long *)block)[n2];
+				if (pred != NULL)
+					*pred = (e >> predShift) & predMask;
+				if (box != NULL)
+					*box = (boxShift != 0) ? e >> boxShift : 0;
+				return e & ((1UL << predShift) - 1);
+			}
+			const Entry * e = &((const Entry *)block)[n2];
+			if (pred != NULL)
+				*pred = e->pred;
+			if (box != NULL)
+				*box = e->box;
+			return e->config;
+		}
+	};
+
 	// Split queue. When processing tree depth X
 	// - the configurations of depth X-1 which are to be examined will be read from queue[(X-1)%2], and
 	// - the successor configurations of depth X will be written into queue[X%2].
-	Entry * volatile * queue[2];
+	// Each second-level array contains BLOCKSIZE entries in the format format[0] or
+	// format[1], respectively.
+	char * volatile * queue[2];
+	Format format[2];
+
+	// Number of bits needed for the configuration numbers and the box numbers
+	unsigned int configBits;
+	unsigned int boxBits;
 
 	// Number of entries in queue[0] and queue[1], respectively
 	unsigned int queue_length;
@@ -47,24 +102,70 @@ class BFSQueue
 	unsigned int depth;
 
 	// This bit set stores all configurations that already have been examined, in order to
-	// avoid (1) cycles and (2) multiple examinations of the same configuration.
-	volatile unsigned int * volatile * bitset;
+	// avoid (1) cycles and (2) multiple examinations of the same configuration. It covers
+	// the whole range of configuration numbers and is stored in 'bitsetMap' (see
+	// MappedArray), so only the parts actually used occupy main memory.
+	MappedArray * bitsetMap;
+	volatile unsigned int * bitset;
 
-	// Maximum number of entries in the bit set
+	// Number of blocks (of BLOCKSIZE entries) of the bit set
 	unsigned int bitset_length;
 
+	// If the range of configuration numbers is too large for the bit set, the visited
+	// configurations are stored in this hash map instead (and 'bitset' is NULL).
+	ConfigHashMap * hashed;
+
 	// Swap file. In order to save main memory, only the information for the current tree depth
 	// X and the tree depth X-1 are kept in main memory. The entries of the queues for smaller
 	// tree depths are exported to a temporary file. When we found a solution, they are needed
-	// again to determine the path which lead to the solution.
-	fstream         file;
+	// again to determine the path which lead to the solution. The file is memory-mapped (see
+	// HistoryFile), so the path can be determined by following pointers.
+	HistoryFile     file;
+
+	// Start (in bytes) and format of each tree depth in the swap file
+	vector<unsigned long> layerStart;
+	vector<Format> layerFormat;
+
+	// If compressHistory is set, each block of a tree depth is compressed separately (see
+	// encodeBlock()). For each tree depth, the index of its first block in 'blockStart',
+	// and for each block, its start (in bytes) in the swap file.
+	vector<unsigned long> layerBlock;
+	vector<unsigned long> blockStart;
+
+	// The old read queue is exported to the swap file by a background thread, so the disk
+	// I/O overlaps with the expansion of the next tree depth. This is possible since the
+	// queue is double-buffered: the exported queue is the new read queue, which is only
+	// read during the next tree depth, and is not overwritten before the next pushDepth().
+	// The export in progress: the thread, the queue, its number of entries and format.
+	pthread_t writer;
+	bool writing;
+	unsigned int exportQueue;
+	unsigned long exportLength;
+	Format exportFormat;
+
+	// Write the queue given by exportQueue/exportLength/exportFormat to the swap file.
+	void exportLayer();
+	static void * runExport(void * queue);
 
-	// Zahl der Eintrge in der Auslagerungsdatei
-	unsigned long   file_length;
+	// Wait until the export in progress (if any) is complete. The swap file may only be
+	// accessed after this.
+	void waitForExport();
 
+	// Directory for checkpoints (empty, if no checkpoints are written). A checkpoint consists
+	// of the swap file (which is kept in this directory), a copy of the bit set, and a small
+	// state file with the tree depth and the layers of the swap file. There are two copies of
+	// the bit set, which are written alternately, so the copy belonging to the last complete
+	// checkpoint is never overwritten; the state file is replaced atomically by rename().
+	string checkpointDir;
 
-	// The queues and bit sets are dynamically allocated block by block, and only when
-	// necessary. For this purpose a two-level array (i.e., an array of arrays) is used instead
+	// For each block of the bit set, the tree depth in which it has been changed last (-1 if
+	// it has never been changed), and for both copies of the bit set, the tree depth of the
+	// checkpoint last written into it. Thus, only the blocks changed since then are written.
+	volatile int * modified;
+	unsigned int lastWritten[2];
+
+
+	// The queues are dynamically allocated block by block, and only when necessary. For this purpose a two-level array (i.e., an array of arrays) is used instead
 	// of a simple array. The second level is only allocated as required (analogous to
 	// two-level page tables in operating systems).
 	// The arrays of the second level have 2^16 entries each. An access to a[i] thus is realized
@@ -80,23 +181,75 @@ class BFSQueue
 	inline unsigned int qIndex1(unsigned long i)  { return i >> BLOCKBITS; }
 	inline unsigned int qIndex2(unsigned long i)  { return i & BLOCKMASK; }
 
-	// The bit set is implemented as a two-level array of 32-bit values. For a given configuration
-	// number, the function bsBitPos returns the bit position within an array element.
+	// Maximum number of entries in a queue (the positions in the read queue are unsigned int's)
+	static const unsigned long MAXLENGTH = 1UL << 32;
+
+	// The bit set is implemented as an array of 32-bit values. For a given configuration
+	// number, the function bsIndex returns the array index, bsBitPos the bit position within
+	// the array element, and bsBlock the block of BLOCKSIZE elements (used for checkpoints).
 	
 	static const unsigned int WORDBITS = 5;                 // 5 Bit = 0..31, bits in one int
 	static const unsigned int WORDMASK = ((1<<WORDBITS)-1); // Bit mask where the last 5 Bits
 	                                                        // are set
 	
-	inline unsigned int bsIndex1(unsigned long i) { return i >> (WORDBITS + BLOCKBITS); }
-	inline unsigned int bsIndex2(unsigned long i) { return (i >> WORDBITS) & BLOCKMASK; }
-	inline unsigned int bsBitPos(unsigned long i) { return i & WORDMASK; }
+	inline unsigned long bsIndex(confno_t i) { return i >> WORDBITS; }
+	inline unsigned int bsBitPos(confno_t i) { return i & WORDMASK; }
+	inline unsigned int bsBlock(confno_t i)  { return i >> (WORDBITS + BLOCKBITS); }
+
+	// lookup_and_add() may be called by several threads concurrently. Therefore, the
+	// second-level arrays of the queues are installed with an atomic compare-and-swap: if two
+	// threads allocate the same block at the same time, the loser deletes its copy and uses
+	// the block of the winner. This function returns the (possibly newly allocated) block.
+	volatile char * getQueueBlock(unsigned int wr, unsigned int n1);
+
+	// Determine the format of the entries whose predecessors are in a queue of length
+	// 'predLength'.
+	Format makeFormat(unsigned int predLength);
+
+	// Compress the first 'n' entries of 'block' (in the format 'f') into 'buf' and return
+	// the number of bytes. The configuration numbers and the predecessor indices are stored
+	// as differences to the previous entry, and all values as variable-length integers
+	// with 7 bits per byte, so the small differences of neighbouring entries need only a
+	// few bytes. Each block is compressed on its own and can thus be read on its own.
+	static unsigned long encodeBlock(const char * block, unsigned long n, const Format & f,
+									 unsigned char * buf);
+
+	// Return the entry at index 'n2' of a block compressed by encodeBlock() (configuration
+	// as return value, predecessor index in *pred).
+	static confno_t decodeEntry(const unsigned char * buf, unsigned long n2, unsigned int * pred);
+
+	// Maximum number of bytes of a variable-length integer
+	static const unsigned int MAXVARINT = sizeof(confno_t) * 8 / 7 + 1;
+
+	// Initialize the queue/bit set for configuration numbers between 0 and numConf-1, and
+	// 'nBox' boxes (used by the constructors).
+	void init(confno_t numConf, unsigned int nBox);
+
+	// Return the name of the file 'name' in the checkpoint directory.
+	string checkpointFile(const char * name);
+
+	// Continue with the last checkpoint in the checkpoint directory.
+	void resume();
 
  public:
+	/**
+	 * Compress the tree depths in the swap file (see encodeBlock()). This must be set
+	 * before the queue is created.
+	 */
+	static bool compressHistory;
+
 	/**
 	 * Constructor: Create a queue/bit set for configuration numbers between
-	 * 0 and numConf-1.
+	 * 0 and numConf-1, and 'nBox' boxes.
 	 */
-	BFSQueue(unsigned long numConf);
+	BFSQueue(confno_t numConf, unsigned int nBox);
+
+	/**
+	 * Constructor: Create a queue/bit set like above, which writes checkpoints into the
+	 * directory 'dir' (see checkpoint()). If 'resume' is true, the search continues with
+	 * the last checkpoint in this directory.
+	 */
+	BFSQueue(confno_t numConf, unsigned int nBox, const char * dir, bool resume);
 
 	/**
 	 * Destructur: deallocate memory.
@@ -114,8 +267,10 @@ class BFSQueue
 	 * Checks if the given configuration is already contained in the bit set. If not, the
 	 * configuration is entered in the bit set and the configuration, the index of the predecessor
 	 * configuration and the number of the moved box are added to the write queue.
+	 * This method is thread-safe and lock-free: the bit is set with an atomic fetch-and-or,
+	 * and the slot in the write queue is reserved with an atomic fetch-and-add.
 	 */
-	bool lookup_and_add(unsigned long conf, unsigned int predIndex, unsigned int box);
+	bool lookup_and_add(confno_t conf, unsigned int predIndex, unsigned int box);
 
 	/**
 	 * Return the length of the read queue.
@@ -126,7 +281,7 @@ class BFSQueue
 	 * Return the i-th entry in the read queue (configuration as return value;
 	 * moved box in *box).
 	 */
-	unsigned long get(unsigned int i, unsigned int * box);
+	confno_t get(unsigned int i, unsigned int * box);
 
 	/**
 	 * Return the solution path as an array of configurations. The parameter conf is the
@@ -134,7 +289,19 @@ class BFSQueue
 	 * the length of the path is returned. The result is allocated dynamically and should be 
 	 * deallocated using delete[].
 	 */
-	unsigned long * getPath(unsigned long conf, unsigned int predIndex, unsigned int * path_length);
+	confno_t * getPath(confno_t conf, unsigned int predIndex, unsigned int * path_length);
+
+	/**
+	 * Write a checkpoint for the current tree depth, which must be called directly after
+	 * pushDepth(). All data is written to the disk before the checkpoint is made valid, so a
+	 * crash while writing leaves the previous checkpoint intact.
+	 */
+	void checkpoint();
+
+	/**
+	 * Return the current tree depth (i.e., the number of calls of pushDepth()).
+	 */
+	unsigned int getDepth();
 
 	/**
 	 * Returns information about RAM and hard disk usage.
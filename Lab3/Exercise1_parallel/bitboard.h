@@ -0,0 +1,260 @@
+// Maximum number of 64-bit words of a bitboard, i.e., at most 2048 cells
+static const unsigned int MAXBOARDWORDS = 32;
+
+/**
+ * A set of cells of the playing field, represented as a bit set with one bit per cell
+ * (bitboard). In contrast to the field numbers used by Playfield and Config, the cells are
+ * numbered row by row, so the neighbor of each cell in a given direction is obtained by adding
+ * a constant offset (see Playfield::cellShift). Thus, the neighbors of all cells in a set can be
+ * computed at once by shifting the whole bit set.
+ * The class is a template on the number of 64-bit words. Playfield::init() determines the
+ * number of words needed for the level (Playfield::boardWords), and the code using bitboards
+ * is instantiated for each possible number, so small levels only work on a single word.
+ * The bitboards of Playfield always have MAXBOARDWORDS words, of which only the first
+ * boardWords words are used; they are converted with the constructor below. Config stores its
+ * bitboards as arrays of exactly boardWords words, which are loaded and stored with the
+ * constructor and storeTo() below.
+ * All methods are declared inline, i.e., a call to a method is replaced by a copy of the
+ * method's body.
+ */
+template <unsigned int WORDS>
+class BitBoard
+{
+ public:
+	// The bits. Bit i of the set is bit (i%64) of word[i/64].
+	unsigned long word[WORDS];
+
+	inline BitBoard()
+	{
+	}
+
+	/**
+	 * Conversion: copy the first words of 'b'. If 'b' has less words, the remaining words
+	 * are cleared.
+	 */
+	template <unsigned int W>
+	inline explicit BitBoard(const BitBoard<W> & b)
+	{
+		unsigned int i = 0;
+		for (; (i<WORDS) && (i<W); i++)
+			word[i] = b.word[i];
+		for (; i<WORDS; i++)
+			word[i] = 0;
+	}
+
+	/**
+	 * Load / store the set from / to an array of WORDS words.
+	 */
+	inline explicit BitBoard(const unsigned long * words)
+	{
+		for (unsigned int i=0; i<WORDS; i++)
+			word[i] = words[i];
+	}
+
+	inline void storeTo(unsigned long * words) const
+	{
+		for (unsigned int i=0; i<WORDS; i++)
+			words[i] = word[i];
+	}
+
+	/**
+	 * Add / remove / test cell 'i' of a set stored as an array of words (see above), without
+	 * loading the set.
+	 */
+	static inline void set(unsigned long * words, unsigned int i)
+	{
+		words[i >> 6] |= 1UL << (i & 63);
+	}
+
+	static inline void reset(unsigned long * words, unsigned int i)
+	{
+		words[i >> 6] &= ~(1UL << (i & 63));
+	}
+
+	static inline bool test(const unsigned long * words, unsigned int i)
+	{
+		return (words[i >> 6] & (1UL << (i & 63))) != 0;
+	}
+
+	/**
+	 * Remove all cells from the set.
+	 */
+	inline void clear()
+	{
+		for (unsigned int i=0; i<WORDS; i++)
+			word[i] = 0;
+	}
+
+	/**
+	 * Add / remove cell 'i' to / from the set.
+	 */
+	inline void set(unsigned int i)
+	{
+		word[i >> 6] |= 1UL << (i & 63);
+	}
+
+	inline void reset(unsigned int i)
+	{
+		word[i >> 6] &= ~(1UL << (i & 63));
+	}
+
+	/**
+	 * Is cell 'i' in the set?
+	 */
+	inline bool test(unsigned int i) const
+	{
+		return (word[i >> 6] & (1UL << (i & 63))) != 0;
+	}
+
+	/**
+	 * Is the set empty?
+	 */
+	inline bool isEmpty() const
+	{
+		unsigned long w = 0;
+		for (unsigned int i=0; i<WORDS; i++)
+			w |= word[i];
+		return w == 0;
+	}
+
+	/**
+	 * Do this set and 'b' have a cell in common?
+	 */
+	inline bool intersects(const BitBoard & b) const
+	{
+		unsigned long w = 0;
+		for (unsigned int i=0; i<WORDS; i++)
+			w |= word[i] & b.word[i];
+		return w != 0;
+	}
+
+	inline bool operator==(const BitBoard & b) const
+	{
+		unsigned long w = 0;
+		for (unsigned int i=0; i<WORDS; i++)
+			w |= word[i] ^ b.word[i];
+		return w == 0;
+	}
+
+	inline BitBoard operator&(const BitBoard & b) const
+	{
+		BitBoard r;
+		for (unsigned int i=0; i<WORDS; i++)
+			r.word[i] = word[i] & b.word[i];
+		return r;
+	}
+
+	inline BitBoard operator|(const BitBoard & b) const
+	{
+		BitBoard r;
+		for (unsigned int i=0; i<WORDS; i++)
+			r.word[i] = word[i] | b.word[i];
+		return r;
+	}
+
+	/**
+	 * Return the cells of this set that are not in 'b'.
+	 */
+	inline BitBoard without(const BitBoard & b) const
+	{
+		BitBoard r;
+		for (unsigned int i=0; i<WORDS; i++)
+			r.word[i] = word[i] & ~b.word[i];
+		return r;
+	}
+
+	inline BitBoard & operator|=(const BitBoard & b)
+	{
+		for (unsigned int i=0; i<WORDS; i++)
+			word[i] |= b.word[i];
+		return *this;
+	}
+
+	inline BitBoard & operator&=(const BitBoard & b)
+	{
+		for (unsigned int i=0; i<WORDS; i++)
+			word[i] &= b.word[i];
+		return *this;
+	}
+
+	/**
+	 * Return the set shifted by 'n' cells towards higher (shiftUp) or lower (shiftDown) cell
+	 * numbers, i.e., cell i of this set becomes cell i+n or i-n of the result. 'n' must be at
+	 * least 1. Cells shifted beyond the bounds of the set are lost. Shifts by less than 64
+	 * cells (i.e., all shifts, unless the rows of the level have 64 or more cells) only
+	 * combine neighboring words.
+	 */
+	inline BitBoard shiftUp(unsigned int n) const
+	{
+		BitBoard r;
+		if (n < 64) {
+			r.word[0] = word[0] << n;
+			for (unsigned int i=1; i<WORDS; i++)
+				r.word[i] = (word[i] << n) | (word[i-1] >> (64-n));
+			return r;
+		}
+		unsigned int q = n >> 6;
+		unsigned int s = n & 63;
+		for (unsigned int i=0; i<WORDS; i++) {
+			unsigned long w = 0;
+			if (i >= q) {
+				w = word[i-q] << s;
+				if ((s != 0) && (i > q))
+					w |= word[i-q-1] >> (64-s);
+			}
+			r.word[i] = w;
+		}
+		return r;
+	}
+
+	inline BitBoard shiftDown(unsigned int n) const
+	{
+		BitBoard r;
+		if (n < 64) {
+			for (unsigned int i=0; i<WORDS-1; i++)
+				r.word[i] = (word[i] >> n) | (word[i+1] << (64-n));
+			r.word[WORDS-1] = word[WORDS-1] >> n;
+			return r;
+		}
+		unsigned int q = n >> 6;
+		unsigned int s = n & 63;
+		for (unsigned int i=0; i<WORDS; i++) {
+			unsigned long w = 0;
+			if (i + q < WORDS) {
+				w = word[i+q] >> s;
+				if ((s != 0) && (i + q + 1 < WORDS))
+					w |= word[i+q+1] << (64-s);
+			}
+			r.word[i] = w;
+		}
+		return r;
+	}
+
+	/**
+	 * Return the cells of 'free' that can be reached from the cells of this set (which must
+	 * be a subset of 'free') by moving towards higher cell numbers through consecutive cells
+	 * of 'free'. This is done for all runs of consecutive cells at once, using the carry
+	 * propagation of an addition: adding the set to 'free' generates a carry from each cell
+	 * of the set through the following cells of 'free'.
+	 */
+	inline BitBoard fillUp(const BitBoard & free) const
+	{
+		BitBoard r;
+		unsigned long carry = 0;
+		for (unsigned int i=0; i<WORDS; i++) {
+			unsigned long f = free.word[i];
+			unsigned long s = word[i];
+			unsigned long sum = f + s;
+			unsigned long c = (sum < f);
+			sum += carry;
+			c |= (sum < carry);
+			// The carries into each bit are sum ^ f ^ s
+			r.word[i] = (s | (sum ^ f ^ s)) & f;
+			carry = c;
+		}
+		return r;
+	}
+};
+
+// Bitboard used for storing the bitboards of any level
+typedef BitBoard<MAXBOARDWORDS> MaxBitBoard;
@@ -1,19 +1,28 @@
 #include <iostream>
+#include <vector>
 #include <stdlib.h>
+#include <omp.h>
 
+#include "confno.h"
 #include "converter.h"
 #include "config.h"
+#include "patterndb.h"
 
 using namespace std;
 
 
-unsigned long Config::nBoxConfigs;
-unsigned long Config::solutionConfNo;
+confno_t Config::nBoxConfigs;
+confno_t Config::solutionConfNo;
+unsigned int Config::maskWords;
+bool Config::detectDeadlocks = false;
+bool Config::usePatterns = false;
+unsigned long * Config::nDeadlocks;
+unsigned int Config::nThreads;
 	
 
 // ==================================================================
 
-static unsigned int log2(unsigned long num)
+static unsigned int log2(confno_t num)
 {
 	unsigned res = 0;
 	for (; num > 0; num >>= 1)
@@ -30,9 +39,27 @@ static unsigned int log2(unsigned long num)
 Config * Config::init(const char * fname)
 {
 	Playfield::init(fname);
+	if (Playfield::nBox > MAXBOX) {
+		cerr << "Error: more than " << MAXBOX << " boxes!\n";
+		exit(1);
+	}
 	Converter::init(Playfield::nPos, Playfield::nBox);
+	maskWords = (Playfield::nPos <= 64) ? 1 : (Playfield::nPos <= 128) ? 2 : MASKWORDS;
 	nBoxConfigs = Converter::getNumConfigs();
+	if (nBoxConfigs > ((confno_t)-1) / (1+3*Playfield::nBox)) {
+		cerr << "Error: too many configurations for " << CONFNO_BITS
+			 << " bit configuration numbers";
+#ifndef WIDE
+		cerr << " (compile with WIDE=1)";
+#endif
+		cerr << "!\n";
+		exit(1);
+	}
 	solutionConfNo = Converter::configToNo(Playfield::goalPos);
+
+	// One row of deadlock counters per thread, each row in its own cache line
+	nThreads = omp_get_max_threads();
+	nDeadlocks = new unsigned long[nThreads * DEADLOCKSTRIDE]();
 	
 	cerr << "#Configs: " << getNumConfigs() << " (2^" << log2(getNumConfigs()) << ") "
 		 << "#BoxConfigs: " << nBoxConfigs << " (2^" << log2(nBoxConfigs) << ") "
@@ -45,16 +72,52 @@ Config * Config::init(const char * fname)
  * Does the specified configuration number represent a solution, i.e., are all boxes on
  * a target?
  */
-bool Config::isSolutionConf(unsigned long conf)
+bool Config::isSolutionConf(confno_t conf)
 {
 	return (conf % nBoxConfigs) == solutionConfNo;
 }
+
+/**
+ * Determine the numbers of all solution configurations, i.e., the configurations with all
+ * boxes on a target and the player in any of the components of the free fields.
+ */
+unsigned int Config::getSolutionConfigs(confno_t confs[])
+{
+	Config goal(solutionConfNo);
+	for (unsigned int c=0; c<goal.nComp; c++)
+		confs[c] = solutionConfNo + c * nBoxConfigs;
+	return goal.nComp;
+}
 	
+/**
+ * Print the number of configurations discarded by each deadlock detector.
+ */
+void Config::printDeadlockStatistics()
+{
+	unsigned long n[NDETECTORS];
+	for (unsigned int d=0; d<NDETECTORS; d++) {
+		n[d] = 0;
+		for (unsigned int t=0; t<nThreads; t++)
+			n[d] += nDeadlocks[t*DEADLOCKSTRIDE + d];
+	}
+	cout << "Deadlocks: " << n[SIMPLE] << " simple, " << n[FROZEN] << " frozen, "
+		 << n[CORRAL] << " corral, " << n[PATTERN] << " pattern\n";
+}
+
+/**
+ * Count a configuration discarded by the deadlock detector 'detector'.
+ */
+inline void Config::countDeadlock(Detector detector)
+{
+	unsigned int t = omp_get_thread_num();
+	nDeadlocks[(t % nThreads) * DEADLOCKSTRIDE + detector]++;
+}
+
 /**
  * Returns the maximum amount of configuration numbers. Thus, the configuration numbers
  * all are in the range 0...getNumConfigs()-1.
  */
-unsigned long Config::getNumConfigs()
+confno_t Config::getNumConfigs()
 {
 	return (1+3*Playfield::nBox) * nBoxConfigs;
 }
@@ -74,38 +137,66 @@ unsigned int Config::numBoxes()
  */
 Config::Config()
 {
-	boxPos = new unsigned int[Playfield::nBox];
-	comp = new unsigned short[Playfield::nFields];
+	allocBoards();
 	for (unsigned int i=0; i<Playfield::nBox; i++)
 		boxPos[i] = Playfield::initialBoxPos[i];
 	initBoxesBitSet();
-	setComponents(comp);
-	configNo = Converter::configToNo(boxPos) + comp[Playfield::initialPlayerPos] * nBoxConfigs;
+	setComponents();
+	configNo = Converter::configToNo(boxPos)
+		+ getComponent(Playfield::initialPlayerPos) * nBoxConfigs;
+	setPushBoards();
 }
 
 /**
  * Constructor: creates a configuration with the specified configuration number.
  */
-Config::Config(unsigned long confNo)
+Config::Config(confno_t confNo)
 {
-	boxPos = new unsigned int[Playfield::nBox];
-	comp = new unsigned short[Playfield::nFields];
+	allocBoards();
 	setConfig(confNo);
 }
 
+/**
+ * Constructor: creates a configuration with the specified configuration number, whose
+ * box positions 'positions' have already been determined using decode().
+ */
+Config::Config(confno_t confNo, const unsigned int * positions)
+{
+	allocBoards();
+	setConfig(confNo, positions);
+}
+
 /**
  * Destructur: deallocate memory.
  */
 Config::~Config()
 {
-	delete[] comp;
-	delete[] boxPos;
+	delete[] boards;
+}
+
+// Allocate the bitboards (see attribute 'boards'): the box positions, four pushable boxes
+// bitboards, and at most MAXCOMP components.
+void Config::allocBoards()
+{
+	boards = new unsigned long[(5 + MAXCOMP) * Playfield::boardWords];
+}
+
+/**
+ * Determine the box positions of 'count' configurations at once (see
+ * Converter::nosToConfigs()).
+ */
+void Config::decode(unsigned int count, const confno_t confNos[], unsigned int positions[])
+{
+	confno_t nos[count];
+	for (unsigned int i=0; i<count; i++)
+		nos[i] = confNos[i] % nBoxConfigs;
+	Converter::nosToConfigs(count, nos, positions);
 }
 
 /**
  * Returns the configuration number for this configuration.
  */
-unsigned long Config::getConfig()
+confno_t Config::getConfig()
 {
 	return configNo;
 }
@@ -113,12 +204,27 @@ unsigned long Config::getConfig()
 /**
  * Updates this configuration to the one with the specified number.
  */
-void Config::setConfig(unsigned long confNo)
+void Config::setConfig(confno_t confNo)
 {
 	Converter::noToConfig(confNo % nBoxConfigs, boxPos);
 	initBoxesBitSet();
-	setComponents(comp);
+	setComponents();
+	configNo = confNo;
+	setPushBoards();
+}
+
+/**
+ * Updates this configuration to the one with the specified number, whose box positions
+ * 'positions' have already been determined using decode().
+ */
+void Config::setConfig(confno_t confNo, const unsigned int * positions)
+{
+	for (unsigned int i=0; i<Playfield::nBox; i++)
+		boxPos[i] = positions[i];
+	initBoxesBitSet();
+	setComponents();
 	configNo = confNo;
+	setPushBoards();
 }
 
 /**
@@ -128,24 +234,32 @@ void Config::setConfig(unsigned long confNo)
  * 'dir' is the direction of movement (0...3)
  * *newBox returns the (new) number of the moved box.
  */
-unsigned long Config::getNextConfig(unsigned int box, unsigned int dir, unsigned int * newBox)
+confno_t Config::getNextConfig(unsigned int box, unsigned int dir, unsigned int * newBox)
+{
+	switch (Playfield::boardWords) {
+	case 1:  return nextConfig<1>(box, dir, newBox);
+	case 2:  return nextConfig<2>(box, dir, newBox);
+	case 4:  return nextConfig<4>(box, dir, newBox);
+	case 8:  return nextConfig<8>(box, dir, newBox);
+	case 16: return nextConfig<16>(box, dir, newBox);
+	default: return nextConfig<MAXBOARDWORDS>(box, dir, newBox);
+	}
+}
+
+template <unsigned int W>
+confno_t Config::nextConfig(unsigned int box, unsigned int dir, unsigned int * newBox)
 {
 	unsigned int pos = boxPos[box];
-	unsigned int playerPos = Playfield::neighbor[dir^2][pos];
-	unsigned int newBoxPos = Playfield::neighbor[dir][pos];
-	unsigned long result = NONE;
+	confno_t result = NONE;
 	
-	if (isReachable(playerPos)
-		&& Playfield::isValid(newBoxPos) && hasNoBox(newBoxPos)
-		&& !Playfield::isDead(newBoxPos)) {
+	if (MaxBitBoard::test(pushBoard(dir), Playfield::cellNo[pos])) {
+		unsigned int newBoxPos = Playfield::neighbor[dir][pos];
 		box = moveBox(box, newBoxPos); // Execute the move
-		// Check whether the box is on a target or can be removed again. If not, the move
-		// leads to a dead-end and is not executed.
-		if (Playfield::isGoal(newBoxPos) || canBeEmptied(newBoxPos, 0L)) {
-			unsigned long confNo = Converter::configToNo(boxPos);
-			unsigned short lcomp[Playfield::nFields];
-			setComponents(lcomp);
-			unsigned int playerComp = lcomp[pos];
+		// Check whether the box is on a target or can be removed again, and apply the
+		// other deadlock detectors. If the move leads to a dead-end, it is not executed.
+		if (!isDeadlock<W>(newBoxPos, pos)) {
+			confno_t confNo = boxesToNo();
+			unsigned int playerComp = getComponentAfterMove<W>(pos);
 			result = confNo + playerComp * nBoxConfigs;
 			if (newBox != NULL)
 				*newBox = box;
@@ -155,13 +269,52 @@ unsigned long Config::getNextConfig(unsigned int box, unsigned int dir, unsigned
 	return result;
 }
 
+/**
+ * Reverse of getNextConfig(): if the current configuration can be reached from a valid
+ * predecessor configuration by moving the box 'box' into direction 'dir', the number of
+ * this predecessor is returned, else 'NONE'. I.e., the box is 'pulled' back by the player,
+ * who must be able to reach the field in front of the box and the field behind it.
+ */
+confno_t Config::getPrevConfig(unsigned int box, unsigned int dir)
+{
+	switch (Playfield::boardWords) {
+	case 1:  return prevConfig<1>(box, dir);
+	case 2:  return prevConfig<2>(box, dir);
+	case 4:  return prevConfig<4>(box, dir);
+	case 8:  return prevConfig<8>(box, dir);
+	case 16: return prevConfig<16>(box, dir);
+	default: return prevConfig<MAXBOARDWORDS>(box, dir);
+	}
+}
+
+template <unsigned int W>
+confno_t Config::prevConfig(unsigned int box, unsigned int dir)
+{
+	unsigned int pos = boxPos[box];
+	unsigned int oldPos = Playfield::neighbor[dir^2][pos];   // Previous box position
+	if (!Playfield::isValid(oldPos) || Playfield::isDead(oldPos) || hasBox(oldPos)
+		|| !isReachable(oldPos))
+		return NONE;
+	unsigned int playerPos = Playfield::neighbor[dir^2][oldPos];  // Previous player position
+	if (!Playfield::isValid(playerPos) || hasBox(playerPos))
+		return NONE;
+	// getNextConfig() only pushes boxes onto fields that are no dead-ends
+	if (!Playfield::isGoal(pos) && !canBeEmptied<W>(pos))
+		return NONE;
+
+	box = moveBox(box, oldPos);
+	confno_t result = boxesToNo() + getComponentOf<W>(playerPos) * nBoxConfigs;
+	moveBox(box, pos);
+	return result;
+}
+
 /**
  * Can the player reach the field 'pos' of the playing field?
  */
 bool Config::isReachable(unsigned int pos)
 {
-	int playerComp = configNo / nBoxConfigs;
-	return Playfield::isValid(pos) && (comp[pos] == playerComp);
+	unsigned int playerComp = configNo / nBoxConfigs;
+	return Playfield::isValid(pos) && MaxBitBoard::test(compBoard(playerComp), Playfield::cellNo[pos]);
 }
 
 /**
@@ -179,13 +332,25 @@ void Config::print()
 // Computes 'boxes' from 'boxPos'.
 void Config::initBoxesBitSet()
 {
-	boxes = 0;
+	for (unsigned int i=0; i<MASKWORDS; i++)
+		boxes[i] = 0;
+	for (unsigned int i=0; i<Playfield::boardWords; i++)
+		boxBoard()[i] = 0;
 	for (unsigned int p=0; p<Playfield::nBox; p++) {
-		if (boxPos[p] >= 64) {
-			cerr << "Boxes: pos >= 64!\n";
-			exit(1);
-		}
-		boxes |= (1L << boxPos[p]);
+		boxes[boxPos[p] >> 6] |= 1UL << (boxPos[p] & 63);
+		MaxBitBoard::set(boxBoard(), Playfield::cellNo[boxPos[p]]);
+	}
+}
+
+// Returns the number of the box configuration stored in 'boxes'. The conversion is
+// instantiated for each possible number of words, so for levels with at most 64 fields
+// only a single word is examined.
+inline confno_t Config::boxesToNo()
+{
+	switch (maskWords) {
+	case 1:  return Converter::maskToNo<1>(boxes);
+	case 2:  return Converter::maskToNo<2>(boxes);
+	default: return Converter::maskToNo<MASKWORDS>(boxes);
 	}
 }
 
@@ -197,70 +362,406 @@ unsigned int Config::moveBox(unsigned int box, unsigned int newPos)
 	unsigned int oldPos = boxPos[box];
 	unsigned int newBoxPos[Playfield::nBox];
 	unsigned int j = 0;
-	unsigned int newBox = -1;
+	unsigned int newBox = 0;
+	bool inserted = false;
 	for (unsigned int i=0; i<Playfield::nBox; i++) {
 		if (j == box)
 			j++;
-		if ((j < Playfield::nBox) && ((boxPos[j] < newPos) || (newBox != -1))) {
+		if ((j < Playfield::nBox) && ((boxPos[j] < newPos) || inserted)) {
 			newBoxPos[i] = boxPos[j++];
 		}
 		else {
 			newBoxPos[i] = newPos;
 			newBox = i;
+			inserted = true;
 		}
 	}
 	for (unsigned int i=0; i<Playfield::nBox; i++)
 		boxPos[i] = newBoxPos[i];
-	boxes &= ~(1L << oldPos);
-	boxes |= (1L << newPos);
+	boxes[oldPos >> 6] &= ~(1UL << (oldPos & 63));
+	boxes[newPos >> 6] |= 1UL << (newPos & 63);
+	MaxBitBoard::reset(boxBoard(), Playfield::cellNo[oldPos]);
+	MaxBitBoard::set(boxBoard(), Playfield::cellNo[newPos]);
 	return newBox;
 }
 
-// Compute the connected components. See attribute 'comp'.
-void Config::setComponents(unsigned short comp[])
-{
-	unsigned int queue[Playfield::nFields];
-	unsigned int in = 0;
-	unsigned int out = 0;
-	unsigned int cn = 0;
-	const unsigned short none = -1;
-
-	for (unsigned int i=0; i<Playfield::nFields; i++)
-		comp[i] = none;
-
-	for (unsigned int i=0; i<Playfield::nFields; i++) {
-		if ((comp[i] == none) && hasNoBox(i)) {
-			comp[i] = cn;
-			queue[in++] = i;
-			while (out < in) {
-				unsigned int pos = queue[out++];
-				for (unsigned int dir=0; dir<4; dir++) {
-					unsigned int n = Playfield::neighbor[dir][pos];
-					if (Playfield::isValid(n) && (comp[n] == none) && hasNoBox(n)) {
-						comp[n] = cn;
-						queue[in++] = n;
-					}
-				}
-			}
-			cn++;
+// Compute the connected components. See attribute 'boards'.
+void Config::setComponents()
+{
+	switch (Playfield::boardWords) {
+	case 1:  setComponents<1>(); break;
+	case 2:  setComponents<2>(); break;
+	case 4:  setComponents<4>(); break;
+	case 8:  setComponents<8>(); break;
+	case 16: setComponents<16>(); break;
+	default: setComponents<MAXBOARDWORDS>(); break;
+	}
+}
+
+template <unsigned int W>
+void Config::setComponents()
+{
+	typedef BitBoard<W> Board;
+	Board free = Board(Playfield::validBoard).without(Board(boxBoard()));
+	Board remaining = free;
+
+	// Each iteration determines the component with the smallest field number that has
+	// not been assigned to a component yet.
+	for (nComp = 0; !remaining.isEmpty(); nComp++) {
+		if (nComp == MAXCOMP) {
+			cerr << "Error: too many connected components!\n";
+			exit(1);
+		}
+		unsigned int pos = Playfield::minField(remaining);
+		Board seed;
+		seed.clear();
+		seed.set(Playfield::cellNo[pos]);
+		Board comp = Playfield::reachable(seed, free);
+		comp.storeTo(compBoard(nComp));
+		compMin[nComp] = pos;
+		remaining = remaining.without(comp);
+	}
+}
+
+// Return the number of the component containing the field 'pos' (which has no box).
+unsigned int Config::getComponent(unsigned int pos)
+{
+	unsigned int c = 0;
+	while (!MaxBitBoard::test(compBoard(c), Playfield::cellNo[pos]))
+		c++;
+	return c;
+}
+
+// After the box on field 'oldPos' has been moved by moveBox() (i.e., boxBoard() already
+// contains the new box position), return the number the player's component would have
+// in the new configuration. The player stands on 'oldPos'. Only the components touching
+// 'oldPos' are recomputed; all other components are not affected by the move.
+template <unsigned int W>
+unsigned int Config::getComponentAfterMove(unsigned int oldPos)
+{
+	typedef BitBoard<W> Board;
+	Board free = Board(Playfield::validBoard).without(Board(boxBoard()));
+	Board seed;
+	seed.clear();
+	seed.set(Playfield::cellNo[oldPos]);
+
+	// The new component of the player and its smallest field number
+	Board player = Playfield::reachable(seed, free);
+	unsigned int min = Playfield::minField(player);
+
+	// The component number is the number of components with a smaller minimal field.
+	// The old components that do not touch 'oldPos' are not changed by the move (note that
+	// the new box position is a neighbor of 'oldPos'), so we can use their minimal fields.
+	// The old components touching 'oldPos' are merged into the area 'touched'.
+	unsigned int playerComp = 0;
+	Board touched = seed;
+	for (unsigned int c=0; c<nComp; c++) {
+		bool touches = false;
+		for (unsigned int dir=0; dir<4; dir++) {
+			unsigned int n = Playfield::neighbor[dir][oldPos];
+			if (Playfield::isValid(n) && MaxBitBoard::test(compBoard(c), Playfield::cellNo[n]))
+				touches = true;
 		}
+		if (touches)
+			touched |= Board(compBoard(c));
+		else if (compMin[c] < min)
+			playerComp++;
+	}
+
+	// By moving the box, the area 'touched' may have been split into several components.
+	// Count the ones (other than the player's component) with a smaller minimal field.
+	Board rest = touched.without(player) & free & Board(Playfield::lowerBoard[min]);
+	while (!rest.isEmpty()) {
+		seed.clear();
+		seed.set(Playfield::cellNo[Playfield::minField(rest)]);
+		rest = rest.without(Playfield::reachable(seed, free));
+		playerComp++;
 	}
+	return playerComp;
 }
 
-// Can position 'pos' of the playing field be emptied? The argument 'path' is a
-// bit set to avoid cycles during the search. It is initialized with 0.
-bool Config::canBeEmptied(unsigned int pos, unsigned long path)
+// Return the number of the component containing the field 'pos' (which has no box) with
+// the box positions in boxBoard(). In contrast to getComponent(), the components are
+// not taken from compBoard(), so this can be used after moveBox().
+template <unsigned int W>
+unsigned int Config::getComponentOf(unsigned int pos)
 {
-	if (!Playfield::isValid(pos))
+	typedef BitBoard<W> Board;
+	Board free = Board(Playfield::validBoard).without(Board(boxBoard()));
+	Board seed;
+	seed.clear();
+	seed.set(Playfield::cellNo[pos]);
+	unsigned int min = Playfield::minField(Playfield::reachable(seed, free));
+
+	// The component number is the number of components with a smaller minimal field
+	unsigned int comp = 0;
+	Board rest = free & Board(Playfield::lowerBoard[min]);
+	while (!rest.isEmpty()) {
+		seed.clear();
+		seed.set(Playfield::cellNo[Playfield::minField(rest)]);
+		rest = rest.without(Playfield::reachable(seed, free));
+		comp++;
+	}
+	return comp;
+}
+
+// Compute the bitboards of pushable boxes. See attribute 'boards'.
+void Config::setPushBoards()
+{
+	switch (Playfield::boardWords) {
+	case 1:  setPushBoards<1>(); break;
+	case 2:  setPushBoards<2>(); break;
+	case 4:  setPushBoards<4>(); break;
+	case 8:  setPushBoards<8>(); break;
+	case 16: setPushBoards<16>(); break;
+	default: setPushBoards<MAXBOARDWORDS>(); break;
+	}
+}
+
+template <unsigned int W>
+void Config::setPushBoards()
+{
+	typedef BitBoard<W> Board;
+	Board boxes(boxBoard());
+	Board player(compBoard(configNo / nBoxConfigs));
+	Board target = Board(Playfield::validBoard).without(boxes).without(Board(Playfield::deadBoard));
+	for (unsigned int dir=0; dir<4; dir++) {
+		// A box can be pushed into direction 'dir' if the player can reach its neighbor in
+		// direction dir^2 and the neighbor in direction 'dir' is a target field.
+		Board push = boxes & Playfield::shiftBoard(player, dir)
+			& Playfield::shiftBoard(target, dir^2);
+		push.storeTo(pushBoard(dir));
+	}
+}
+
+// Can position 'pos' of the playing field be emptied? I.e., is it free, or can the box
+// on it be moved horizontally or vertically, because both neighbors in that direction
+// can be emptied?
+template <unsigned int W>
+bool Config::canBeEmptied(unsigned int pos)
+{
+	typedef BitBoard<W> Board;
+	unsigned int cell = Playfield::cellNo[pos];
+	Board boxes(boxBoard());
+
+	// Compute the set of fields that can be emptied for all boxes at once: starting with
+	// the free fields, repeatedly add the boxes whose left and right, or upper and lower
+	// neighbors can be emptied, until the set does not grow any more. (Boxes depending on
+	// each other in a cycle are never added, so they cannot be emptied.)
+	Board empty = Board(Playfield::validBoard).without(boxes);
+	while (!empty.test(cell)) {
+		Board movable = (Playfield::shiftBoard(empty, 0) & Playfield::shiftBoard(empty, 2))
+			| (Playfield::shiftBoard(empty, 1) & Playfield::shiftBoard(empty, 3));
+		Board grown = empty | (boxes & movable);
+		if (grown == empty)
+			return false;
+		empty = grown;
+	}
+	return true;
+}
+
+/**
+ * Check whether the configuration is a deadlock after a box has been moved to the field
+ * 'newPos' by moveBox(); the player stands on field 'playerPos'. See 'detectDeadlocks' and
+ * 'usePatterns'.
+ */
+template <unsigned int W>
+bool Config::isDeadlock(unsigned int newPos, unsigned int playerPos)
+{
+	typedef BitBoard<W> Board;
+	if (!Playfield::isGoal(newPos) && !canBeEmptied<W>(newPos)) {
+		if (detectDeadlocks || usePatterns)
+			countDeadlock(SIMPLE);
+		return true;
+	}
+	if (usePatterns && PatternDB::matches(newPos, boxes, boxPos, Playfield::nBox)) {
+		countDeadlock(PATTERN);
+		return true;
+	}
+	if (!detectDeadlocks)
 		return false;
-	if (hasNoBox(pos))
+
+	// Frozen boxes that are not on a target can never reach a target. If the moved box can
+	// still be moved, no other box has been frozen by the move.
+	Board frozen = getFrozenBoxes<W>(newPos);
+	if (!frozen.isEmpty()) {
+		Board valid(Playfield::validBoard);
+		Board goals(Playfield::goalBoard);
+		Board boxes(boxBoard());
+		if (!frozen.without(goals).isEmpty()) {
+			countDeadlock(FROZEN);
+			return true;
+		}
+
+		// The player can never pass a frozen box. So, all fields it can ever reach are
+		// contained in 'region' (assuming that all other boxes can be moved out of the way),
+		// and no box can ever be pushed out of or into this region.
+		Board seed;
+		seed.clear();
+		seed.set(Playfield::cellNo[playerPos]);
+		Board region = Playfield::reachable(seed, valid.without(frozen));
+		Board outside = valid.without(region);
+		if (!(outside & goals).without(boxes).isEmpty()
+			|| !(outside & boxes).without(goals).isEmpty()) {
+			countDeadlock(CORRAL);
+			return true;
+		}
+	}
+	if (isCorralDeadlock<W>(newPos, playerPos, frozen)) {
+		countDeadlock(CORRAL);
 		return true;
-	if ((path & (1L<<pos)) != 0)
+	}
+	return false;
+}
+
+/**
+ * Check whether the move of a box to the field 'newPos' created a corral that can never be
+ * solved; the player stands on field 'playerPos', 'frozen' contains the boxes that can never
+ * be moved again (all of them on a target). The corral consists of the free fields next to
+ * the moved box that the player cannot reach, its fence of the boxes bordering these fields.
+ */
+template <unsigned int W>
+bool Config::isCorralDeadlock(unsigned int newPos, unsigned int playerPos,
+							  const BitBoard<W> & frozen)
+{
+	typedef BitBoard<W> Board;
+	Board valid(Playfield::validBoard);
+	Board boxes(boxBoard());
+	Board free = valid.without(boxes);
+	Board seed;
+	seed.clear();
+	seed.set(Playfield::cellNo[playerPos]);
+	Board reach = Playfield::reachable(seed, free);
+	seed.clear();
+	for (unsigned int dir=0; dir<4; dir++) {
+		unsigned int n = Playfield::neighbor[dir][newPos];
+		if (Playfield::isValid(n))
+			seed.set(Playfield::cellNo[n]);
+	}
+	Board corral = Playfield::reachable(seed.without(reach), free);
+	if (corral.isEmpty())
+		return false;
+	Board fence = boxes & (Playfield::shiftBoard(corral, 0) | Playfield::shiftBoard(corral, 1)
+						   | Playfield::shiftBoard(corral, 2) | Playfield::shiftBoard(corral, 3));
+	if (fence.without(Board(Playfield::goalBoard)).isEmpty())
 		return false;
-	path |= (1L<<pos);
-	return (canBeEmptied(Playfield::neighbor[0][pos], path)
-			&& canBeEmptied(Playfield::neighbor[2][pos], path))
-		|| (canBeEmptied(Playfield::neighbor[1][pos], path)
-			&& canBeEmptied(Playfield::neighbor[3][pos], path));
+	unsigned int k = 0;
+	unsigned int cur[MAXCORRALBOX + 1];
+	for (unsigned int i=0; i<Playfield::nBox; i++) {
+		if (fence.test(Playfield::cellNo[boxPos[i]])) {
+			if (k == MAXCORRALBOX)
+				return false;
+			cur[k++] = boxPos[i];
+		}
+	}
+
+	// Breadth first search for the positions of the fence boxes, where all other boxes
+	// except the frozen ones are removed. If the position is solvable, the fence boxes
+	// can also be moved onto targets without the other boxes (which would only be in the
+	// way). So, it is a deadlock if the search finds no position with all fence boxes on a
+	// target. As this is only checked for small corrals, the search gives up (i.e., there
+	// is no deadlock) as soon as the player enters the corral, or after CORRALNODES
+	// positions. Each position consists of the sorted box positions and the player's
+	// position, which is replaced by the smallest field it can reach when it is expanded.
+	Board area = valid.without(frozen.without(fence));
+	unsigned int n = k + 1;
+	cur[k] = playerPos;
+	vector<unsigned int> queue(cur, cur + n);
+	vector<unsigned int> seen;
+	for (unsigned long q=0; q<queue.size(); q+=n) {
+		Board sub;
+		sub.clear();
+		for (unsigned int j=0; j<k; j++) {
+			cur[j] = queue[q+j];
+			sub.set(Playfield::cellNo[cur[j]]);
+		}
+		Board free = area.without(sub);
+		seed.clear();
+		seed.set(Playfield::cellNo[queue[q+k]]);
+		Board reach = Playfield::reachable(seed, free);
+		if (reach.intersects(corral))
+			return false;
+		cur[k] = Playfield::minField(reach);
+		bool known = false;
+		for (unsigned long s=0; s<seen.size() && !known; s+=n) {
+			unsigned int j = 0;
+			while (j < n && seen[s+j] == cur[j])
+				j++;
+			known = (j == n);
+		}
+		if (known)
+			continue;
+		if (seen.size() == CORRALNODES * n)
+			return false;
+		seen.insert(seen.end(), cur, cur + n);
+
+		for (unsigned int b=0; b<k; b++) {
+			for (unsigned int dir=0; dir<4; dir++) {
+				unsigned int from = Playfield::neighbor[dir^2][cur[b]];
+				unsigned int to = Playfield::neighbor[dir][cur[b]];
+				if (!Playfield::isValid(from) || !reach.test(Playfield::cellNo[from])
+					|| !Playfield::isValid(to) || Playfield::isDead(to)
+					|| !free.test(Playfield::cellNo[to]))
+					continue;
+				// Push the box and keep the positions sorted (the player stands on the
+				// box's old position)
+				unsigned int next[MAXCORRALBOX + 1];
+				bool solved = Playfield::isGoal(to);
+				bool placed = false;
+				unsigned int m = 0;
+				for (unsigned int j=0; j<k; j++) {
+					if (j == b)
+						continue;
+					if (!placed && to < cur[j]) {
+						next[m++] = to;
+						placed = true;
+					}
+					next[m++] = cur[j];
+					solved = solved && Playfield::isGoal(cur[j]);
+				}
+				if (!placed)
+					next[m++] = to;
+				if (solved)
+					return false;
+				next[k] = cur[b];
+				queue.insert(queue.end(), next, next + n);
+			}
+		}
+	}
+	return true;
 }
 
+/**
+ * Return the bitboard with the boxes that can never be moved again, or an empty bitboard if
+ * the box on field 'pos' can be moved. In contrast to canBeEmptied(), a box can only be moved
+ * along an axis if it can be pushed onto a field that is no dead-end.
+ */
+template <unsigned int W>
+BitBoard<W> Config::getFrozenBoxes(unsigned int pos)
+{
+	typedef BitBoard<W> Board;
+	unsigned int cell = Playfield::cellNo[pos];
+	Board valid(Playfield::validBoard);
+	Board boxes(boxBoard());
+
+	// Like in canBeEmptied(), compute the set of fields that can be emptied. A box can be
+	// moved horizontally if both neighbors can be emptied and at least one of them is no
+	// dead-end (the box is pushed onto this neighbor); vertically likewise.
+	Board live = valid.without(Board(Playfield::deadBoard));
+	Board liveH = Playfield::shiftBoard(live, 0) | Playfield::shiftBoard(live, 2);
+	Board liveV = Playfield::shiftBoard(live, 1) | Playfield::shiftBoard(live, 3);
+	Board empty = valid.without(boxes);
+	while (true) {
+		Board movable = (Playfield::shiftBoard(empty, 0) & Playfield::shiftBoard(empty, 2)
+						 & liveH)
+			| (Playfield::shiftBoard(empty, 1) & Playfield::shiftBoard(empty, 3) & liveV);
+		Board grown = empty | (boxes & movable);
+		if (grown.test(cell)) {
+			grown.clear();
+			return grown;
+		}
+		if (grown == empty)
+			return boxes.without(empty);
+		empty = grown;
+	}
+}
@@ -18,7 +18,7 @@ class Config
 	 * Special configuration number that allows getNextConfig() to indicate, that there is
 	 * no successor configuration.
 	 */
-	static const unsigned long NONE = -1L;
+	static const confno_t NONE = (confno_t)-1;
 
 	/**
 	 * Initialization: The file 'fname' contains a string representation of the Sokoban level,
@@ -30,13 +30,44 @@ class Config
 	 * Does the specified configuration number represent a solution, i.e., are all boxes on
 	 * a target?
 	 */
-	static bool isSolutionConf(unsigned long conf);
+	static bool isSolutionConf(confno_t conf);
+
+	/**
+	 * Determine the numbers of all solution configurations, i.e., the configurations with all
+	 * boxes on a target and the player in any of the components of the free fields. The
+	 * numbers are stored in 'confs', which must have space for 1+3*numBoxes() entries.
+	 * Returns the number of solution configurations.
+	 */
+	static unsigned int getSolutionConfigs(confno_t confs[]);
+
+	/**
+	 * Deadlock detectors used by getNextConfig() in addition to the check whether the moved
+	 * box can be removed again (see canBeEmptied()). If 'detectDeadlocks' is true, successor
+	 * configurations are also discarded if
+	 *  - FROZEN: a box that is not on a target can never be moved again (e.g., boxes
+	 *    blocking each other against a wall, or boxes between two dead-ends), or
+	 *  - CORRAL: the frozen boxes and the walls enclose a region the player can never enter,
+	 *    which contains an empty target or a box that is not on a target, or
+	 *    the push created a corral (free fields the player cannot reach) whose fence of
+	 *    boxes can never be moved onto targets, even if all other boxes were removed.
+	 * If 'usePatterns' is true, successor configurations are also discarded if
+	 *  - PATTERN: the boxes contain a deadlock pattern including the moved box (see PatternDB).
+	 * For each detector, the number of discarded configurations is counted.
+	 */
+	enum Detector { SIMPLE, FROZEN, CORRAL, PATTERN, NDETECTORS };
+	static bool detectDeadlocks;
+	static bool usePatterns;
+
+	/**
+	 * Print the number of configurations discarded by each deadlock detector.
+	 */
+	static void printDeadlockStatistics();
 
 	/**
 	 * Returns the maximum amount of configuration numbers. Thus, the configuration numbers
 	 * all are in the range 0...getNumConfigs()-1.
 	 */
-	static unsigned long getNumConfigs();
+	static confno_t getNumConfigs();
 
 	/**
 	 * Return the number of boxes.
@@ -51,22 +82,41 @@ class Config
 	/**
 	 * Constructor: creates a configuration with the specified configuration number.
 	 */
-	Config(unsigned long confNo);
+	Config(confno_t confNo);
+
+	/**
+	 * Constructor: creates a configuration with the specified configuration number, whose
+	 * box positions 'positions' have already been determined using decode().
+	 */
+	Config(confno_t confNo, const unsigned int * positions);
 
 	/**
 	 * Destructur: deallocate memory.
 	 */
 	~Config();
 
+	/**
+	 * Determine the box positions of 'count' configurations at once (see
+	 * Converter::nosToConfigs()). The positions of the boxes of configuration confNos[i]
+	 * are stored in positions[i*numBoxes()] ... positions[(i+1)*numBoxes()-1].
+	 */
+	static void decode(unsigned int count, const confno_t confNos[], unsigned int positions[]);
+
 	/**
 	 * Returns the configuration number for this configuration.
 	 */
-	unsigned long getConfig();
+	confno_t getConfig();
 
 	/**
 	 * Updates this configuration to the one with the specified number.
 	 */
-	void setConfig(unsigned long confNo);
+	void setConfig(confno_t confNo);
+
+	/**
+	 * Updates this configuration to the one with the specified number, whose box positions
+	 * 'positions' have already been determined using decode().
+	 */
+	void setConfig(confno_t confNo, const unsigned int * positions);
 
 	/**
 	 * If a valid successor configuration can be reached from the current configuration by moving
@@ -75,7 +125,15 @@ class Config
 	 * 'dir' is the direction of movement (0...3)
 	 * *newBox returns the (new) number of the moved box.
 	 */
-	unsigned long getNextConfig(unsigned int box, unsigned int dir, unsigned int * newBox);
+	confno_t getNextConfig(unsigned int box, unsigned int dir, unsigned int * newBox);
+
+	/**
+	 * Reverse of getNextConfig(): if the current configuration can be reached from a valid
+	 * predecessor configuration by moving the box 'box' into direction 'dir', the number of
+	 * this predecessor is returned, else 'NONE'. I.e., the box is 'pulled' back by the player,
+	 * who must be able to reach the field in front of the box and the field behind it.
+	 */
+	confno_t getPrevConfig(unsigned int box, unsigned int dir);
 
 	/**
 	 * Steht auf dem Feld pos des Spielfelds eine Kiste?
@@ -84,7 +142,7 @@ class Config
 	 */
 	inline bool hasBox(unsigned int pos)
 	{
-		return Playfield::isValid(pos) && ((boxes & (1L << pos)) != 0);
+		return Playfield::isValid(pos) && MaxBitBoard::test(boxBoard(), Playfield::cellNo[pos]);
 	}
 
 	/**
@@ -99,51 +157,153 @@ class Config
 	
  private:
 	// Number of configurations just for the boxes (without player)
-	static unsigned long nBoxConfigs;
+	static confno_t nBoxConfigs;
 	
 	// Configuration number of the solution (all boxes are on their target positions)
-	static unsigned long solutionConfNo;
+	static confno_t solutionConfNo;
+
+	// Maximum number of boxes and maximum number of connected components. Except for the
+	// bitboards, all arrays of a configuration have a fixed size. The bitboards are allocated
+	// once for each configuration, which can then be reused with setConfig().
+	static const unsigned int MAXBOX = 24;
+	static const unsigned int MAXCOMP = 1 + 3*MAXBOX;
 
+	// Maximum number of 64-bit words of the bit set 'boxes' (i.e., at most 256 fields, see
+	// Converter::init()), and the number of words actually used for the current level. The
+	// latter is chosen in init() from the number of fields (1, 2 or 4 words).
+	static const unsigned int MASKWORDS = 4;
+	static unsigned int maskWords;
 
 	// Configuration number of this configuration
-	unsigned long configNo;
+	confno_t configNo;
 
 	// Array storing the positions of the boxes on the playing field. This array is always
 	// sorted according to the positions!
-	unsigned int * boxPos;
+	unsigned int boxPos[MAXBOX];
 
-	// Bit set with the positions of the boxes. I.e., if bit 'i' is set, there is a box on
-	// field 'i' of the playing field.
-	unsigned long boxes;
+	// Bit set with the positions of the boxes. I.e., if bit 'i%64' of boxes[i/64] is set,
+	// there is a box on field 'i' of the playing field. Only the first 'maskWords' words
+	// are used.
+	unsigned long boxes[MASKWORDS];
 
-	// For for each position of the playing field, this array contains the connected component
-	// associated with that position. The player can only move within its current connected
-	// component. For each possible position of the player, this array therefore indicates
-	// which other fields the player can reach.
-	unsigned short * comp;
+	// The bitboards of the configuration (see class BitBoard). Each of them has
+	// Playfield::boardWords words, so the size of the array depends on the level:
+	// - boxBoard() is the bitboard with the positions of the boxes.
+	// - pushBoard(dir) is the bitboard with the boxes that the player can push into direction
+	//   'dir', i.e., the player can reach the field behind the box, and the field in front of
+	//   the box is neither a wall, nor a box, nor a dead-end field.
+	// - compBoard(c) is the bitboard with the fields of the connected component 'c' (see
+	//   below).
+	unsigned long * boards;
 
+	inline unsigned long * boxBoard()
+	{
+		return boards;
+	}
 
-	// Computes 'boxes' from 'boxPos'.
-	void initBoxesBitSet();
-	
-	// Checks whether the field with number 'pos' has no box on it.
-	// For efficiency reasons, this method is declared inline, i.e., a call to this method is
-	// replaced by a copy of the method's body.
-	inline bool hasNoBox(int pos)
+	inline unsigned long * pushBoard(unsigned int dir)
 	{
-		return (pos >= 64) || ((boxes & (1L << pos)) == 0);
+		return &boards[(1 + dir) * Playfield::boardWords];
 	}
 
+	inline unsigned long * compBoard(unsigned int c)
+	{
+		return &boards[(5 + c) * Playfield::boardWords];
+	}
+
+	// The connected components of the fields without a box. The player can only move within
+	// its current connected component. The components are numbered in the order of their
+	// smallest field number; compMin[c] is the smallest field number of component 'c'.
+	// 'nComp' is the number of components.
+	unsigned int compMin[MAXCOMP];
+	unsigned int nComp;
+
+	// Configurations are not copied (the bitboards would be shared).
+	Config(const Config &);
+	Config & operator=(const Config &);
+
+	// Allocate the bitboards.
+	void allocBoards();
+
+	// The methods working on bitboards are templates on the number of words of the
+	// bitboards, and are instantiated for 1, 2, 4, ..., MAXBOARDWORDS words. The public methods
+	// and the methods without template parameter call the instantiation for
+	// Playfield::boardWords words, so small levels only work on a single word.
+
+	// See getNextConfig() and getPrevConfig().
+	template <unsigned int W>
+	confno_t nextConfig(unsigned int box, unsigned int dir, unsigned int * newBox);
+	template <unsigned int W>
+	confno_t prevConfig(unsigned int box, unsigned int dir);
+
+
+	// Computes 'boxes' from 'boxPos'.
+	void initBoxesBitSet();
+
+	// Returns the number of the box configuration stored in 'boxes'.
+	inline confno_t boxesToNo();
+
 	// Move the 'box'-th box to the field with number 'newPos' and return the new
 	// number of the box (since the boxes are always sorted according to their
 	// position on the playing field).
 	unsigned int moveBox(unsigned int box, unsigned int newPos);
 
-	// Compute the connected components. See attribute 'comp'.
-	void setComponents(unsigned short comp[]);
+	// Compute the connected components. See attribute 'boards'.
+	void setComponents();
+	template <unsigned int W> void setComponents();
+
+	// Compute the bitboards of pushable boxes. See attribute 'boards'.
+	void setPushBoards();
+	template <unsigned int W> void setPushBoards();
+
+	// Return the number of the component containing the field 'pos' (which has no box).
+	unsigned int getComponent(unsigned int pos);
+
+	// After the box on field 'oldPos' has been moved by moveBox() (i.e., boxBoard() already
+	// contains the new box position), return the number the player's component would have
+	// in the new configuration. The player stands on 'oldPos'. Only the components touching
+	// 'oldPos' are recomputed; all other components are not affected by the move.
+	template <unsigned int W> unsigned int getComponentAfterMove(unsigned int oldPos);
+
+	// Return the number of the component containing the field 'pos' (which has no box) with
+	// the box positions in boxBoard(). In contrast to getComponent(), the components are
+	// not taken from compBoard(), so this can be used after moveBox().
+	template <unsigned int W> unsigned int getComponentOf(unsigned int pos);
+
+	// Number of configurations discarded by each deadlock detector. Each thread counts in its
+	// own row nDeadlocks[t*DEADLOCKSTRIDE ... t*DEADLOCKSTRIDE+NDETECTORS-1] (so the counters
+	// need no atomic operations), the rows are summed up by printDeadlockStatistics().
+	static const unsigned int DEADLOCKSTRIDE = (NDETECTORS + 7) & ~7;
+	static unsigned long * nDeadlocks;
+	static unsigned int nThreads;
+
+	// Count a configuration discarded by the deadlock detector 'detector'.
+	static void countDeadlock(Detector detector);
+
+	// Check whether the configuration is a deadlock after a box has been moved to the field
+	// 'newPos' by moveBox(); the player stands on field 'playerPos'. See 'detectDeadlocks' and
+	// 'usePatterns'.
+	template <unsigned int W> bool isDeadlock(unsigned int newPos, unsigned int playerPos);
+
+	// Check whether the move of a box to the field 'newPos' created a corral that can never
+	// be solved; the player stands on field 'playerPos', 'frozen' contains the boxes that can
+	// never be moved again. See 'detectDeadlocks'.
+	template <unsigned int W> bool isCorralDeadlock(unsigned int newPos, unsigned int playerPos,
+												   const BitBoard<W> & frozen);
+
+	// Maximum number of boxes of a corral's fence, and maximum number of positions searched
+	// by isCorralDeadlock().
+	static const unsigned int MAXCORRALBOX = 6;
+	static const unsigned int CORRALNODES = 128;
+
+	// Return the bitboard with the boxes that can never be moved again, or an empty bitboard
+	// if the box on field 'pos' can be moved. In contrast to canBeEmptied(), a box can only
+	// be moved along an axis if it can be pushed onto a field that is no dead-end.
+	template <unsigned int W> BitBoard<W> getFrozenBoxes(unsigned int pos);
 
-	// Can position 'pos' of the playing field be emptied? The argument 'path' is a
-	// bit set to avoid cycles during the search. It is initialized with 0.
-	bool canBeEmptied(unsigned int pos, unsigned long path);
+	// Can position 'pos' of the playing field be emptied? I.e., is it free, or can the box
+	// on it be moved horizontally or vertically, because both neighbors in that direction
+	// can be emptied?
+	template <unsigned int W> bool canBeEmptied(unsigned int pos);
 };
 
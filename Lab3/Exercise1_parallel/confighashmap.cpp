@@ -0,0 +1,164 @@
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <iostream>
+
+#include "confno.h"
+#include "confighashmap.h"
+
+using namespace std;
+
+/**
+ * Hashed mapping from configuration numbers to small values (e.g., tree depths). It is used by
+ * BFSQueue, PartBFSQueue and DFSDepthMap instead of their two-level arrays if the range of
+ * configuration numbers is too large for a directly addressed array.
+ */
+
+
+/**
+ * Check whether a directly addressed array of 'bytes' bytes can be used, i.e., whether
+ * it fits into the main memory. Otherwise, a ConfigHashMap should be used.
+ */
+bool ConfigHashMap::fitsDense(confno_t bytes)
+{
+	confno_t mem = (confno_t)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+	return bytes <= mem;
+}
+
+/**
+ * Constructor: Creates an empty map.
+ */
+ConfigHashMap::ConfigHashMap()
+{
+	for (unsigned int i=0; i<NSEG; i++) {
+		segs[i].lock = 0;
+		segs[i].size = INITSIZE;
+		segs[i].used = 0;
+		segs[i].keys = new confno_t[INITSIZE];
+		segs[i].values = new unsigned char[INITSIZE]();
+	}
+}
+
+/**
+ * Destructor: deallocate memory.
+ */
+ConfigHashMap::~ConfigHashMap()
+{
+	for (unsigned int i=0; i<NSEG; i++) {
+		delete[] segs[i].keys;
+		delete[] segs[i].values;
+	}
+}
+
+/**
+ * Checks whether there is an entry for 'conf' with a value <= 'value' (which must not
+ * be 0). If so, return 'false', else set the value of 'conf' to 'value' and return 'true'.
+ * The old value (0, if there was no entry) is returned in '*old', if 'old' is not NULL.
+ * This method is thread-safe.
+ */
+bool ConfigHashMap::lookup_and_set(confno_t conf, unsigned char value, unsigned char * old)
+{
+	unsigned long h = hashConfNo(conf);
+	Segment * s = &segs[h >> (64 - SEGBITS)];
+	bool result = false;
+
+	// Acquire the lock of the segment
+	while (__sync_lock_test_and_set(&s->lock, 1) != 0) {
+		while (s->lock != 0)
+			;
+	}
+
+	// Search the configuration or the first empty slot behind its home slot
+	unsigned long mask = s->size - 1;
+	unsigned long i = h & mask;
+	while ((s->values[i] != 0) && (s->keys[i] != conf))
+		i = (i + 1) & mask;
+
+	unsigned char v = s->values[i];
+	if (old != NULL)
+		*old = v;
+	if ((v == 0) || (v > value)) {
+		s->keys[i] = conf;
+		s->values[i] = value;
+		result = true;
+		if (v == 0) {
+			s->used++;
+			if (2 * s->used > s->size)
+				grow(s);
+		}
+	}
+
+	__sync_lock_release(&s->lock);
+	return result;
+}
+
+/**
+ * Return the value of 'conf', or 0 if there is no entry. This method is thread-safe.
+ */
+unsigned char ConfigHashMap::get(confno_t conf)
+{
+	unsigned long h = hashConfNo(conf);
+	Segment * s = &segs[h >> (64 - SEGBITS)];
+
+	// Acquire the lock of the segment
+	while (__sync_lock_test_and_set(&s->lock, 1) != 0) {
+		while (s->lock != 0)
+			;
+	}
+
+	unsigned long mask = s->size - 1;
+	unsigned long i = h & mask;
+	while ((s->values[i] != 0) && (s->keys[i] != conf))
+		i = (i + 1) & mask;
+	unsigned char v = s->values[i];
+
+	__sync_lock_release(&s->lock);
+	return v;
+}
+
+/**
+ * Double the size of segment 's'. Must be called with the segment locked.
+ */
+void ConfigHashMap::grow(Segment * s)
+{
+	unsigned long size = 2 * s->size;
+	confno_t * keys = new confno_t[size];
+	unsigned char * values = new unsigned char[size]();
+	for (unsigned long j=0; j<s->size; j++) {
+		if (s->values[j] != 0) {
+			unsigned long i = hashConfNo(s->keys[j]) & (size - 1);
+			while (values[i] != 0)
+				i = (i + 1) & (size - 1);
+			keys[i] = s->keys[j];
+			values[i] = s->values[j];
+		}
+	}
+	delete[] s->keys;
+	delete[] s->values;
+	s->keys = keys;
+	s->values = values;
+	s->size = size;
+}
+
+/**
+ * Return the number of entries.
+ */
+unsigned long ConfigHashMap::entries()
+{
+	unsigned long n = 0;
+	for (unsigned int i=0; i<NSEG; i++)
+		n += segs[i].used;
+	return n;
+}
+
+/**
+ * Return the number of KBytes used by the map.
+ */
+unsigned long ConfigHashMap::memory()
+{
+	unsigned long size = 0;
+	for (unsigned int i=0; i<NSEG; i++)
+		size += segs[i].size * (sizeof(confno_t) + 1);
+	return size / 1024;
+}
@@ -0,0 +1,78 @@
+using namespace std;
+
+/**
+ * Hashed mapping from configuration numbers to small values (e.g., tree depths). It is used by
+ * BFSQueue, PartBFSQueue and DFSDepthMap instead of their two-level arrays if the range of
+ * configuration numbers is too large for a directly addressed array, i.e., if even the first
+ * level of the array could not be allocated. Its size only depends on the number of entries,
+ * not on the range of the configuration numbers.
+ * The map is split into NSEG segments, which are selected by the most significant bits of the
+ * hash value of the configuration number. Each segment is an open addressing hash table with
+ * linear probing, which is doubled in size when it is half full. Each segment is protected by
+ * its own spin lock, so threads accessing different segments do not block each other.
+ */
+class ConfigHashMap
+{
+ private:
+	/*
+	 * One segment of the map. A value of 0 marks an empty slot.
+	 */
+	class Segment {
+	public:
+		volatile int lock;         // Spin lock (0 = free)
+		unsigned long size;        // Number of slots (power of 2)
+		unsigned long used;        // Number of used slots
+		confno_t * keys;           // Configuration numbers
+		unsigned char * values;    // Values; 0 = empty slot
+		char pad[64];              // Padding to avoid false sharing between segments
+	};
+
+	static const unsigned int SEGBITS = 8;                 // 8 Bit, 256 segments
+	static const unsigned int NSEG = (1<<SEGBITS);         // Number of segments
+	static const unsigned long INITSIZE = 1024;            // Initial number of slots per segment
+
+	Segment segs[NSEG];
+
+	// Double the size of segment 's'. Must be called with the segment locked.
+	void grow(Segment * s);
+
+ public:
+	/**
+	 * Check whether a directly addressed array of 'bytes' bytes can be used, i.e., whether
+	 * it fits into the main memory. Otherwise, a ConfigHashMap should be used.
+	 */
+	static bool fitsDense(confno_t bytes);
+
+	/**
+	 * Constructor: Creates an empty map.
+	 */
+	ConfigHashMap();
+
+	/**
+	 * Destructor: deallocate memory.
+	 */
+	~ConfigHashMap();
+
+	/**
+	 * Checks whether there is an entry for 'conf' with a value <= 'value' (which must not
+	 * be 0). If so, return 'false', else set the value of 'conf' to 'value' and return 'true'.
+	 * The old value (0, if there was no entry) is returned in '*old', if 'old' is not NULL.
+	 * This method is thread-safe.
+	 */
+	bool lookup_and_set(confno_t conf, unsigned char value, unsigned char * old);
+
+	/**
+	 * Return the value of 'conf', or 0 if there is no entry. This method is thread-safe.
+	 */
+	unsigned char get(confno_t conf);
+
+	/**
+	 * Return the number of entries.
+	 */
+	unsigned long entries();
+
+	/**
+	 * Return the number of KBytes used by the map.
+	 */
+	unsigned long memory();
+};
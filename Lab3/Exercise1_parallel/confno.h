@@ -0,0 +1,58 @@
+using namespace std;
+
+/**
+ * Type of the configuration numbers. By default, configuration numbers are 64-bit integers.
+ * For levels with more configurations, the program can be compiled with the preprocessor
+ * flag WIDE (make WIDE=1), which uses 128-bit integers instead. Since this makes all
+ * configuration numbers (and the queue entries containing them) twice as large, the flag
+ * should only be used if it is really necessary (Config::init() reports an error if the
+ * configuration numbers do not fit into 64 bits).
+ */
+#ifdef WIDE
+typedef unsigned __int128 confno_t;
+#else
+typedef unsigned long confno_t;
+#endif
+
+// Number of bits of a configuration number
+static const unsigned int CONFNO_BITS = 8 * sizeof(confno_t);
+
+/**
+ * Return the position of the most significant bit set in 'x' (which must not be 0).
+ */
+static inline unsigned int highestBit(confno_t x)
+{
+#ifdef WIDE
+	unsigned long high = (unsigned long)(x >> 64);
+	if (high != 0)
+		return 127 - __builtin_clzl(high);
+#endif
+	return 63 - __builtin_clzl((unsigned long)x);
+}
+
+/**
+ * Return a hash value for the configuration number 'x'. All bits of 'x' influence all bits
+ * of the hash value.
+ */
+static inline unsigned long hashConfNo(confno_t x)
+{
+	unsigned long h = (unsigned long)x;
+#ifdef WIDE
+	h ^= (unsigned long)(x >> 64) * 0xc2b2ae3d27d4eb4fUL;
+#endif
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdUL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53UL;
+	h ^= h >> 33;
+	return h;
+}
+
+#ifdef WIDE
+#include <iostream>
+
+/**
+ * Output of a 128-bit configuration number (the standard library has no operator for it).
+ */
+ostream & operator<<(ostream & os, confno_t x);
+#endif
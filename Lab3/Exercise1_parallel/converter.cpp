@@ -1,86 +1,31 @@
 #include <stdlib.h>
 
+#include <iostream>
+
+#include "confno.h"
 #include "converter.h"
 
+using namespace std;
+
 
 unsigned int  Converter::maxN;             // Number of fields
 unsigned int  Converter::maxK;             // Number of boxes
-unsigned long ** Converter::cacheNoverK;   // cacheNoverK[n][k] contains (n+1) over (k+1)
-unsigned long *** Converter::cacheConfNo;  // cacheConfNo[n][k][s] contains the number
-                                           // of the first configuration where the first
-                                           // box is on field 's'.
-
-// Initialize the array cacheNoverK.
-void Converter::initNoverK()
-{
-	// (n k) = n*(n-1)*...*(n-k+1) / k*(k-1)*...*1
-	// (n k) = (n-1 k) * n / (n-k)
-	// (n k) = (n k-1) * (n-k+1) / k
-	for (unsigned int n=1; n<=maxN; n++) {
-		cacheNoverK[n-1][0] = n;
-		for (unsigned int k=2; k<=maxK; k++) {
-			cacheNoverK[n-1][k-1] = cacheNoverK[n-1][k-2] * (n-k+1) / k;
-		}
-	}
-}
-
-// Returns the value of the binomial coefficient 'n over k' (n k).
-unsigned long Converter::nOverK(unsigned int n, unsigned int k)
-{
-	return k == 0 ? 1 : cacheNoverK[n-1][k-1];
-}
-
-// Initialize the array cacheConfNo.
-void Converter::initConfNo()
-{
-	for (unsigned int n=1; n<maxN; n++) {
-		for (unsigned int k=0; k<=n && k<maxK; k++) {
-			cacheConfNo[n][k][0] = 0;
-			for (unsigned int i=1; i<=n-k; i++) {
-				cacheConfNo[n][k][i] = cacheConfNo[n][k][i-1] + nOverK(n-i+1,k);
-			}
-		}
-	}
-}
+unsigned int  Converter::stride;           // Length of a row of 'cacheNoverK'
+confno_t * Converter::cacheNoverK;         // cacheNoverK[k*stride + n] contains n over k
+unsigned char * Converter::guide;          // Guide table for findPos()
 
-// Return the number of the first configuration where the first
-// box is on field 's'.
-unsigned long Converter::confNo(unsigned int n, unsigned int k, unsigned int s)
+// Return the smallest number belonging to the given entry of the guide table.
+confno_t Converter::guideValue(unsigned int index)
 {
-	return cacheConfNo[n-1][k-1][s];
-}
-
-// Find the largest entry <= 'no' in the array 'ary[lo:hi-1]' and return its index.
-unsigned int Converter::find(unsigned long ary[], unsigned int lo, unsigned int hi,
-							 unsigned long no)
-{
-	while (lo < hi) {
-		int m = (lo+hi+1)/2;
-		if (ary[m] == no)
-			return m;
-		if (ary[m] < no) {
-			lo = m;
-		}
-		else {
-			hi = m-1;
-		}
-	}
-	return lo;
-}
-
-// In a situation with 'n' remaining fields and 'k' remaining boxes for a configuration
-// number 'no', search the position 's' of the first remaining box and the number of the
-// first configuration, where this box is on field 's'.
-unsigned int Converter::findPos(unsigned int n, unsigned int k, unsigned long no, unsigned long* val)
-{
-	unsigned long * ary = cacheConfNo[n-1][k-1];
-	unsigned int pos = find(ary, 0, n-k, no);
-	*val = ary[pos];
-	return pos;
+	if (index < 64)
+		return index;
+	unsigned int e = (index - 64) / 64 + 6;
+	confno_t m = (index - 64) % 64;
+	return (64 | m) << (e - 6);
 }
 
 // =========================================================
-	
+
 /** Initialize the class. Arguments:
  *   n = number of fields
  *   k = number of boxes
@@ -89,48 +34,110 @@ void Converter::init(unsigned int n, unsigned int k)
 {
 	maxN = n;
 	maxK = k;
-	
-	cacheNoverK = new unsigned long*[n];
-	for (unsigned int i=0; i<n; i++)
-		cacheNoverK[i] = new unsigned long[k]();
-	initNoverK();
-	
-	cacheConfNo = new unsigned long**[n];
-	for (unsigned int i=0; i<n; i++) {
-		cacheConfNo[i] = new unsigned long*[k];
-		for (unsigned int j=0; j<k; j++)
-			cacheConfNo[i][j] = new unsigned long[n]();
+	if (n > 255) {
+		cerr << "Error: too many fields!\n";
+		exit(1);
+	}
+
+	// Allocate the table of binomial coefficients. Each row is aligned to a cache line
+	// (64 bytes).
+	stride = (n + 2 + 7) & ~7;
+	void * mem;
+	if (posix_memalign(&mem, 64, (k+1) * stride * sizeof(confno_t)) != 0) {
+		cerr << "Error: cannot allocate memory!\n";
+		exit(1);
+	}
+	cacheNoverK = (confno_t *)mem;
+
+	// (n 0) = 1, (n k) = (n-1 k-1) + (n-1 k)
+	// The coefficients up to (n k) must not overflow, since they are needed for the
+	// configuration numbers. The remaining entries are only used as sentinels for findPos(),
+	// so they are clipped to the largest possible value.
+	for (unsigned int i=0; i<stride; i++)
+		cacheNoverK[i] = 1;
+	for (unsigned int j=1; j<=k; j++) {
+		cacheNoverK[j*stride] = 0;
+		for (unsigned int i=1; i<stride; i++) {
+			confno_t a = cacheNoverK[(j-1)*stride + i-1];
+			confno_t b = cacheNoverK[j*stride + i-1];
+			if (a + b < a) {
+				if (i <= n) {
+					cerr << "Error: too many configurations for " << CONFNO_BITS
+						 << " bit configuration numbers";
+#ifndef WIDE
+					cerr << " (compile with WIDE=1)";
+#endif
+					cerr << "!\n";
+					exit(1);
+				}
+				cacheNoverK[j*stride + i] = (confno_t)-1;
+			}
+			else
+				cacheNoverK[j*stride + i] = a + b;
+		}
+	}
+
+	// Initialize the guide table: for each entry, the largest position 'pos' < n
+	// with (pos over j) <= the smallest number of this entry.
+	guide = new unsigned char[k * GUIDESIZE];
+	for (unsigned int j=1; j<=k; j++) {
+		unsigned int pos = j-1;
+		for (unsigned int i=0; i<GUIDESIZE; i++) {
+			confno_t no = guideValue(i);
+			while ((pos+1 < n) && (nOverK(pos+1, j) <= no))
+				pos++;
+			guide[(j-1)*GUIDESIZE + i] = pos;
+		}
 	}
-	initConfNo();
 }
 
 /** Return the number of possible box configurations. */
-unsigned long Converter::getNumConfigs()
+confno_t Converter::getNumConfigs()
 {
 	return nOverK(maxN, maxK);
 }
 
-/** Determine the configuration number from the box positions in 'boxpos'. */
-unsigned long Converter::configToNo(unsigned int boxpos[])
+/**
+ * Batch version of configToNo(): convert 'count' configurations at once.
+ */
+void Converter::configsToNos(unsigned int count, const unsigned int boxpos[], confno_t nos[])
 {
-	unsigned long no = 0;
-	unsigned int startpos = 0;
-	for (unsigned int i=0; i<maxK; i++) {
-		no += confNo(maxN-startpos, maxK-i, boxpos[i]-startpos);
-		startpos = boxpos[i] + 1;
-	}
-	return no;
+	for (unsigned int c=0; c<count; c++)
+		nos[c] = configToNo(&boxpos[c*maxK]);
 }
 
-/** Determine the box positions corresponding to the specified configuration number. */
-void Converter::noToConfig(unsigned long no, unsigned int * boxpos)
+/**
+ * Batch version of noToConfig(): convert 'count' configurations at once. The outer loop
+ * runs over the boxes, so the searches for the same box of different configurations are
+ * independent of each other.
+ */
+void Converter::nosToConfigs(unsigned int count, const confno_t nos[], unsigned int boxpos[])
 {
-	unsigned int startpos = 0;
-	for (unsigned int i=0; i<maxK; i++) {
-		unsigned long val;
-		unsigned int pos = findPos(maxN-startpos, maxK-i, no, &val);
-		boxpos[i] = startpos + pos;
-		no -= val;
-		startpos = boxpos[i] + 1;
+	confno_t no[count];
+	for (unsigned int c=0; c<count; c++)
+		no[c] = nos[c];
+	for (unsigned int k=maxK; k>0; k--) {
+		for (unsigned int c=0; c<count; c++) {
+			unsigned int pos = findPos(k, no[c]);
+			boxpos[c*maxK + k-1] = pos;
+			no[c] -= nOverK(pos, k);
+		}
 	}
 }
+
+#ifdef WIDE
+/**
+ * Output of a 128-bit configuration number (the standard library has no operator for it).
+ */
+ostream & operator<<(ostream & os, confno_t x)
+{
+	char buf[40];
+	int i = sizeof(buf) - 1;
+	buf[i] = 0;
+	do {
+		buf[--i] = '0' + (int)(x % 10);
+		x /= 10;
+	} while (x != 0);
+	return os << &buf[i];
+}
+#endif
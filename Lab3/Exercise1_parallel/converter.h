@@ -2,6 +2,10 @@
  * This class (with only static attributes and methods) converts a configuration of boxes,
  * i.e., an array containing the positions of the boxes, into an integer (the configuration
  * number), and vice versa.
+ * The configuration number is the rank of the set of box positions in the combinatorial
+ * number system: for the sorted positions p[0] < p[1] < ... < p[k-1], it is the sum of the
+ * binomial coefficients (p[i] over i+1). Thus, the conversion only needs one table lookup per
+ * box. All binomial coefficients are stored in a single flat, cache-aligned table.
  */
 class Converter
 {
@@ -11,44 +15,109 @@ class Converter
 	 *   k = number of boxes
 	 */
 	static void init(unsigned int n, unsigned int k);
-	
+
 	/** Return the number of possible box configurations. */
-	static unsigned long getNumConfigs();
-	
-	/** Determine the configuration number from the box positions in 'boxpos'. */
-	static unsigned long configToNo(unsigned int boxpos[]);
-	
-	/** Determine the box positions corresponding to the specified configuration number. */
-	static void noToConfig(unsigned long no, unsigned int * bospos);
-	
+	static confno_t getNumConfigs();
+
+	/**
+	 * Determine the configuration number from the box positions in 'boxpos'.
+	 * For efficiency reasons, this method is declared inline, i.e., a call to this method is
+	 * replaced by a copy of the method's body.
+	 */
+	static inline confno_t configToNo(const unsigned int boxpos[])
+	{
+		confno_t no = 0;
+		for (unsigned int i=0; i<maxK; i++)
+			no += nOverK(boxpos[i], i+1);
+		return no;
+	}
+
+	/**
+	 * Determine the configuration number from a bit set of the box positions consisting of
+	 * 'W' 64-bit words, i.e., bit 'p%64' of mask[p/64] is set if there is a box on field 'p'.
+	 * The set bits are enumerated in increasing order by counting the trailing zeros, so no
+	 * array of positions is needed. Since 'W' is a template parameter, the loop over the words
+	 * is unrolled by the compiler; for W = 1 only a single word is examined.
+	 */
+	template <unsigned int W>
+	static inline confno_t maskToNo(const unsigned long mask[])
+	{
+		confno_t no = 0;
+		unsigned int i = 1;
+		for (unsigned int w=0; w<W; w++) {
+			for (unsigned long m = mask[w]; m != 0; i++) {
+				no += nOverK(64*w + __builtin_ctzl(m), i);
+				m &= m - 1;
+			}
+		}
+		return no;
+	}
+
+	/**
+	 * Determine the box positions corresponding to the specified configuration number.
+	 * For efficiency reasons, this method is declared inline.
+	 */
+	static inline void noToConfig(confno_t no, unsigned int * boxpos)
+	{
+		for (unsigned int k=maxK; k>0; k--) {
+			unsigned int pos = findPos(k, no);
+			boxpos[k-1] = pos;
+			no -= nOverK(pos, k);
+		}
+	}
+
+	/**
+	 * Batch versions of configToNo() and noToConfig(), which convert 'count' configurations
+	 * at once. 'boxpos' contains the box positions of all configurations one after the other,
+	 * i.e., the positions of configuration 'i' start at boxpos[i*k]. Since the conversions of
+	 * different configurations are independent of each other, the processor can overlap
+	 * their table lookups.
+	 */
+	static void configsToNos(unsigned int count, const unsigned int boxpos[], confno_t nos[]);
+	static void nosToConfigs(unsigned int count, const confno_t nos[], unsigned int boxpos[]);
+
  private:
 	static unsigned int maxN;              // Number of fields
 	static unsigned int maxK;              // Number of boxes
-	static unsigned long ** cacheNoverK;   // cacheNoverK[n][k] contains (n+1) over (k+1)
-	static unsigned long *** cacheConfNo;  // cacheConfNo[n][k][s] contains the number
-	                                       // of the first configuration where the first
-                                           // box is on field 's'.
-	
-	// Initialize the array cacheNoverK.
-	static void initNoverK();
-	
+	static unsigned int stride;            // Length of a row of 'cacheNoverK'
+	static confno_t * cacheNoverK;         // cacheNoverK[k*stride + n] contains n over k
+	                                       // (k = 0 ... maxK, n = 0 ... maxN)
+	static unsigned char * guide;          // Guide table for findPos(), see there
+
+	// Number of entries in the guide table for each number of boxes
+	static const unsigned int GUIDESIZE = 64 + (CONFNO_BITS-6)*64;
+
 	// Returns the value of the binomial coefficient 'n over k' (n k).
-	static unsigned long nOverK(unsigned int n, unsigned int k);
-	
-	// Initialize the array cacheConfNo.
-	static void initConfNo();
-	
-	// Return the number of the first configuration where the first
-	// box is on field 's'.
-	static unsigned long confNo(unsigned int n, unsigned int k, unsigned int s);
-	
-	// Find the largest entry <= 'no' in the array 'ary[lo:hi-1]' and return its index.
-	static unsigned int find(unsigned long ary[], unsigned int lo, unsigned int hi,
-							 unsigned long no);
-	
-	// In a situation with 'n' remaining fields and 'k' remaining boxes for a configuration
-	// number 'no', search the position 's' of the first remaining box and the number of the
-	// first configuration, where this box is on field 's'.
-	static unsigned int findPos(unsigned int n, unsigned int k, unsigned long no,
-								unsigned long* val);
+	static inline confno_t nOverK(unsigned int n, unsigned int k)
+	{
+		return cacheNoverK[k*stride + n];
+	}
+
+	// Return the index into the guide table for the (remaining) configuration number 'no'.
+	// Numbers below 64 have an entry of their own; larger numbers are grouped by their most
+	// significant 7 bits (like a floating point number with a 6 bit mantissa).
+	static inline unsigned int guideIndex(confno_t no)
+	{
+		if (no < 64)
+			return no;
+		unsigned int e = highestBit(no);
+		return 64 + (e-6)*64 + ((no >> (e-6)) & 63);
+	}
+
+	// Return the smallest number belonging to the given entry of the guide table.
+	static confno_t guideValue(unsigned int index);
+
+	// For 'k' remaining boxes and the (remaining) configuration number 'no', return the
+	// position 'pos' of the last of these boxes, i.e., the largest 'pos' with
+	// (pos over k) <= no. The guide table contains this position for the smallest number
+	// of each entry; since the binomial coefficients grow faster than the entries, at most
+	// a few steps are needed from there.
+	static inline unsigned int findPos(unsigned int k, confno_t no)
+	{
+		unsigned int pos = guide[(k-1)*GUIDESIZE + guideIndex(no)];
+		const confno_t * row = &cacheNoverK[k*stride];
+		while (row[pos+1] <= no)
+			pos++;
+		return pos;
+	}
 };
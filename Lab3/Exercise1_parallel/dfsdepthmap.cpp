@@ -1,6 +1,12 @@
+#include <omp.h>
+
 #include <string>
 #include <iostream>
 
+#include "confno.h"
+#include "confighashmap.h"
+#include "transtable.h"
+#include "mappedarray.h"
 #include "dfsdepthmap.h"
 
 using namespace std;
@@ -18,11 +24,47 @@ using namespace std;
  * Constructor: Creates a new mapping for configuration numbers between
  * 0 and numConf-1 and a maximum depth of 'maxDepth'.
  */
-DFSDepthMap::DFSDepthMap(unsigned long numConf, unsigned int maxDepth)
+DFSDepthMap::DFSDepthMap(confno_t numConf, unsigned int maxDepth)
+{
+	// The array needs numConf bytes in the worst case. If this does not fit into the
+	// main memory, use a hash map instead.
+	if (ConfigHashMap::fitsDense(numConf)) {
+		depthMap = new MappedArray(numConf);
+		depth = (volatile unsigned char *)depthMap->data();
+		hashed = NULL;
+	}
+	else {
+		depthMap = NULL;
+		depth = NULL;
+		hashed = new ConfigHashMap();
+	}
+	table = NULL;
+	initCounters(maxDepth);
+}
+
+/**
+ * Constructor: Creates a new mapping for a maximum depth of 'maxDepth', which uses a
+ * transposition table of (at most) 'mBytes' MBytes (see TranspositionTable). Since
+ * entries may be replaced, configurations can be counted more than once.
+ */
+DFSDepthMap::DFSDepthMap(unsigned int maxDepth, unsigned long mBytes)
 {
-	depth_length = index1(numConf-1) + 1;
-	depth = new volatile unsigned char*[depth_length]();
-	nConfigs = new volatile unsigned int[maxDepth+1]();
+	depthMap = NULL;
+	depth = NULL;
+	hashed = NULL;
+	table = new TranspositionTable(mBytes);
+	initCounters(maxDepth);
+}
+
+/**
+ * Allocate the counters for a maximum depth of 'maxDepth'.
+ */
+void DFSDepthMap::initCounters(unsigned int maxDepth)
+{
+	// One row of counters per thread, each row starting in its own cache line
+	nThreads = omp_get_max_threads();
+	stride = (maxDepth + 16) & ~15;
+	nConfigs = new int[nThreads * stride]();
 }
 
 /**
@@ -30,10 +72,19 @@ DFSDepthMap::DFSDepthMap(unsigned long numConf, unsigned int maxDepth)
  */
 DFSDepthMap::~DFSDepthMap()
 {
-	for (unsigned int i=0; i<depth_length; i++) {
-		delete[] depth[i];
-	}
-	delete[] depth;
+	delete depthMap;
+	delete hashed;
+	delete table;
+	delete[] nConfigs;
+}
+
+/**
+ * Return the row of counters of the calling thread.
+ */
+int * DFSDepthMap::getCounters()
+{
+	unsigned int t = omp_get_thread_num();
+	return &nConfigs[(t % nThreads) * stride];
 }
 
 /**
@@ -41,43 +92,112 @@ DFSDepthMap::~DFSDepthMap()
  * If so, return 'false', else set the depth of 'conf' in the mapping to
  * 'newDepth' and return 'true'.
  */
-bool DFSDepthMap::lookup_and_set(unsigned long conf, unsigned int newDepth)
+bool DFSDepthMap::lookup_and_set(confno_t conf, unsigned int newDepth)
 {
-	unsigned int i1 = index1(conf);
-	unsigned int i2 = index2(conf);
-
-	// If necessary, allocate an array at the second level and initialize it with 0
-	if (depth[i1] == NULL)
-		depth[i1] = new unsigned char[BLOCKSIZE]();
-	
-	// If there is an entry with equal or smaller depth: we are done
-	unsigned char old = depth[i1][i2];
-	if ((old != 0) && (old <= (unsigned char)newDepth))
-		return false;
-
-	// Enter the depth and update the number of configurations for this depth
-	depth[i1][i2] = (unsigned char)newDepth;
+	unsigned char old;
+	if (hashed != NULL) {
+		if (!hashed->lookup_and_set(conf, newDepth, &old))
+			return false;
+	}
+	else if (table != NULL) {
+		if (!table->lookup_and_set(conf, newDepth, &old))
+			return false;
+	}
+	else {
+		volatile unsigned char * entry = &depth[conf];
+
+		// Store the minimum of the old and the new depth. If another thread has changed the
+		// entry in the meantime, the compare-and-swap fails and we retry with its value.
+		old = *entry;
+		for (;;) {
+			// If there is an entry with equal or smaller depth: we are done
+			if ((old != 0) && (old <= (unsigned char)newDepth))
+				return false;
+			unsigned char seen = __sync_val_compare_and_swap(entry, old, (unsigned char)newDepth);
+			if (seen == old)
+				break;
+			old = seen;
+		}
+	}
+
+	// Update the number of configurations for this depth
+	int * counters = getCounters();
 	if (old != 0)
-		nConfigs[old]--;
-	nConfigs[newDepth]++;
-		
+		counters[old]--;
+	counters[newDepth]++;
 	return true;
 }
 
+/**
+ * Checks whether there is an entry for 'conf'. If so, return 'false', else set the
+ * depth of 'conf' in the mapping to 'newDepth' and return 'true'. This method is
+ * thread-safe and lock-free, too; it is used by the breadth first search, where the
+ * first depth found for a configuration is always the lowest.
+ */
+bool DFSDepthMap::lookup_and_add(confno_t conf, unsigned int newDepth)
+{
+	if ((hashed != NULL) || (table != NULL)) {
+		unsigned char old;
+		if (hashed != NULL)
+			hashed->lookup_and_set(conf, newDepth, &old);
+		else
+			table->lookup_and_set(conf, newDepth, &old);
+		if (old != 0)
+			return false;
+	}
+	else {
+		volatile unsigned char * entry = &depth[conf];
+
+		// If there is an entry: we are done (plain read to avoid the atomic operation)
+		if (*entry != 0)
+			return false;
+		if (!__sync_bool_compare_and_swap(entry, 0, (unsigned char)newDepth))
+			return false;
+	}
+	getCounters()[newDepth]++;
+	return true;
+}
+
+/**
+ * Return the depth stored for 'conf', or 0 if there is no entry.
+ */
+unsigned int DFSDepthMap::getDepth(confno_t conf)
+{
+	if (hashed != NULL)
+		return hashed->get(conf);
+	if (table != NULL)
+		return table->get(conf);
+	return depth[conf];
+}
+
+/**
+ * Return the number of KBytes used by the mapping.
+ */
+unsigned long DFSDepthMap::memory()
+{
+	if (hashed != NULL)
+		return hashed->memory();
+	if (table != NULL)
+		return table->memory();
+	return depthMap->resident();
+}
+
 /**
  * Returns information about RAM and hard disk usage and the number of
  * examined configurations for all depths < 'maxDepth'.
  */
 void DFSDepthMap::statistics(unsigned int maxDepth)
 {
-	for (unsigned int i=1; i<maxDepth; i++)
-		cerr << "depth " << i << ": " << nConfigs[i] << "\n";
-			 
-	unsigned int size = depth_length/1024*sizeof(unsigned int);
-	for (unsigned int i=0; i<depth_length; i++) {
-		if (depth[i] != NULL)
-			size += BLOCKSIZE/1024;
+	for (unsigned int i=1; i<maxDepth; i++) {
+		int n = 0;
+		for (unsigned int t=0; t<nThreads; t++)
+			n += nConfigs[t*stride + i];
+		cerr << "depth " << i << ": " << n << "\n";
 	}
-	cout << "Used " << size << " KBytes for arrays\n";
+			 
+	cout << "Used " << memory() << " KBytes for " << ((hashed != NULL) ? "hash map" :
+		 (table != NULL) ? "transposition table" : "arrays") << "\n";
+	if (table != NULL)
+		table->statistics();
 }
 
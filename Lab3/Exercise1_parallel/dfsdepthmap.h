@@ -9,37 +9,46 @@ using namespace std;
 class DFSDepthMap
 {
  private:
-	// The map is implemented as a two-level array (i.e., an array of arrays), where the second
-	// level is only allocated as required (analogous to two-level page tables in operating
-	// systems).
-	// The arrays of the second level have 2^16 entries each. An access to a[i] thus is realized
-	// as a[i/2^16][i%2^16], where we first check, if a[i/2^16] != NULL. If not, we will allocate
-	// the second-level array. For computing the first and second index, we use inline functions.
-	// The compiler will copy their code directly to the place where they are used.
-	
-	static const unsigned int BLOCKBITS = 16;                 // 16 Bit, arrays with 65536 int's
-	static const unsigned int BLOCKSIZE = (1<<BLOCKBITS);     // Block size for allocation: 2^16
-	static const unsigned int BLOCKMASK = ((1<<BLOCKBITS)-1); // Bit mask where the last 16 bits
-	                                                          // are set
-	
-	inline unsigned int index1(unsigned long i)  { return i >> BLOCKBITS; }
-	inline unsigned int index2(unsigned long i)  { return i & BLOCKMASK; }
+	// Mapping from configuration number to tree depth. The array covers the whole range of
+	// configuration numbers and is stored in 'depthMap' (see MappedArray), so the operating
+	// system only allocates the parts actually used.
+	MappedArray * depthMap;
+	volatile unsigned char * depth;
 
-	// Mapping from configuration number to tree depth, using a two-level array
-	volatile unsigned char * volatile * depth;
-	
-	// Number of entries in 'depth'
-	unsigned int depth_length;
+	// If the range of configuration numbers is too large for the array, the depths are
+	// stored in this hash map instead (and 'depth' is NULL).
+	ConfigHashMap * hashed;
+
+	// If the map has been created with a memory budget, the depths are stored in this
+	// transposition table instead (and 'depth' and 'hashed' are NULL).
+	TranspositionTable * table;
+
+	// For correctness checking: number of configurations at each tree depth. Each thread
+	// counts in its own row nConfigs[t*stride ... t*stride+maxDepth] (so the counters need
+	// no atomic operations), the rows are summed up by statistics().
+	int * nConfigs;
+	unsigned int stride;
+	unsigned int nThreads;
 
-	// For correctness checking: number of configurations at each tree depth
-	volatile unsigned int * nConfigs;
+	// Return the row of counters of the calling thread.
+	int * getCounters();
+
+	// Allocate the counters for a maximum depth of 'maxDepth'.
+	void initCounters(unsigned int maxDepth);
 
  public:
 	/**
 	 * Constructor: Creates a new mapping for configuration numbers between
 	 * 0 and numConf-1 and a maximum depth of 'maxDepth'.
 	 */
-	DFSDepthMap(unsigned long numConf, unsigned int maxDepth);
+	DFSDepthMap(confno_t numConf, unsigned int maxDepth);
+
+	/**
+	 * Constructor: Creates a new mapping for a maximum depth of 'maxDepth', which uses a
+	 * transposition table of (at most) 'mBytes' MBytes (see TranspositionTable). Since
+	 * entries may be replaced, configurations can be counted more than once.
+	 */
+	DFSDepthMap(unsigned int maxDepth, unsigned long mBytes);
 	
 	/**
 	 *  Destructur: deallocate memory.
@@ -49,9 +58,28 @@ class DFSDepthMap
 	/**
 	 * Checks whether there is an entry for 'conf' with a depth <= 'newDepth'.
 	 * If so, return 'false', else set the depth of 'conf' in the mapping to
-	 * 'newDepth' and return 'true'.
+	 * 'newDepth' and return 'true'. This method is thread-safe and lock-free (if the
+	 * array is used): the depth is lowered with an atomic compare-and-swap loop.
+	 */
+	bool lookup_and_set(confno_t conf, unsigned int newDepth);
+
+	/**
+	 * Checks whether there is an entry for 'conf'. If so, return 'false', else set the
+	 * depth of 'conf' in the mapping to 'newDepth' and return 'true'. This method is
+	 * thread-safe and lock-free, too; it is used by the breadth first search, where the
+	 * first depth found for a configuration is always the lowest.
+	 */
+	bool lookup_and_add(confno_t conf, unsigned int newDepth);
+
+	/**
+	 * Return the depth stored for 'conf', or 0 if there is no entry.
+	 */
+	unsigned int getDepth(confno_t conf);
+
+	/**
+	 * Return the number of KBytes used by the mapping.
 	 */
-	bool lookup_and_set(unsigned long conf, unsigned int newDepth);
+	unsigned long memory();
 
 	/**
 	 * Returns information about RAM and hard disk usage and the number of
@@ -1,6 +1,9 @@
+#include <stdlib.h>
+
 #include <string>
 #include <iostream>
 
+#include "confno.h"
 #include "dfsstack.h"
 
 using namespace std;
@@ -13,39 +16,32 @@ using namespace std;
 
 
 /**
- * Constructor: Creates a stack with maximum depth 'maxDepth'.
+ * Constructor: Creates a stack with maximum depth 'maxDepth', i.e., for paths of at most
+ * 'maxDepth' configurations (or 'maxDepth'-1 pushes).
  */
 DFSStack::DFSStack(unsigned int maxDepth)
 {
-	stack_length = maxDepth;
-	stack = new unsigned long[stack_length];
+	if (maxDepth > MAXDEPTH) {
+		cerr << "Error: maximum depth is " << MAXDEPTH-1 << " pushes!\n";
+		exit(1);
+	}
 	sp = 0;
 }
 
 /**
- * Copy constructor: Creates a copy of the given stack.
+ * Copy constructor: Creates a copy of the given stack. Only the used entries are copied.
  */
-DFSStack::DFSStack(DFSStack &from)
+DFSStack::DFSStack(const DFSStack &from)
 {
-	stack_length = from.stack_length;
-	stack = new unsigned long[stack_length];
 	sp = from.sp;
 	for (unsigned int i=0; i<sp; i++)
 		stack[i] = from.stack[i];
 }
-	
-/**
- * Destructur: deallocate memory.
- */
-DFSStack::~DFSStack()
-{
-	delete[] stack;
-}
 
 /**
  * Pushes the given configuration number onto the stack.
  */
-void DFSStack::push(unsigned long conf)
+void DFSStack::push(confno_t conf)
 {
 	stack[sp++] = conf;
 }
@@ -71,9 +67,9 @@ unsigned int DFSStack::length()
  * the length of this path is returned. The result is allocated dynamically and
  * should be deallocated using delete[].
  */
-unsigned long * DFSStack::getPath(unsigned int * path_length)
+confno_t * DFSStack::getPath(unsigned int * path_length)
 {
-	unsigned long * path = new unsigned long[sp];
+	confno_t * path = new confno_t[sp];
 	for (unsigned int i=0; i<sp; i++)
 		path[i] = stack[i];
 	*path_length = sp;
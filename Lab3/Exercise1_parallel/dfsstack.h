@@ -6,34 +6,34 @@ using namespace std;
  */
 class DFSStack
 {
+ public:
+	// Maximum depth of a stack. The depths in DFSDepthMap are stored as unsigned char's,
+	// so a search can never be deeper anyway.
+	static const unsigned int MAXDEPTH = 256;
+
  private:
-	// Stack: array of configuration numbers
-	unsigned long * stack;
-	// Length of the 'stack' array
-	unsigned int stack_length;
+	// Stack: array of configuration numbers. The array has a fixed size, so a copy of a
+	// stack (e.g., for a new task) needs a single allocation.
+	confno_t stack[MAXDEPTH];
 	// Stack pointer
 	unsigned int sp;
 
  public:
 	/**
-	 * Constructor: Creates a stack with maximum depth 'maxDepth'.
+	 * Constructor: Creates a stack with maximum depth 'maxDepth', i.e., for paths of at most
+	 * 'maxDepth' configurations (or 'maxDepth'-1 pushes).
 	 */
 	DFSStack(unsigned int maxDepth);
 
 	/**
-	 * Copy constructor: Creates a copy of the given stack.
-	 */
-	DFSStack(DFSStack &from);
-
-	/**
-	 * Destructur: deallocate memory.
+	 * Copy constructor: Creates a copy of the given stack. Only the used entries are copied.
 	 */
-	~DFSStack();
+	DFSStack(const DFSStack &from);
 
 	/**
 	 * Pushes the given configuration number onto the stack.
 	 */
-	void push(unsigned long conf);
+	void push(confno_t conf);
 
 	/**
 	 * Pops the topmost configuration number from the stack.
@@ -50,5 +50,5 @@ class DFSStack
 	 * the length of this path is returned. The result is allocated dynamically and
 	 * should be deallocated using delete[].
 	 */
-	unsigned long * getPath(unsigned int * path_length);
+	confno_t * getPath(unsigned int * path_length);
 };
@@ -0,0 +1,304 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <omp.h>
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+
+#include "confno.h"
+#include "converter.h"
+#include "config.h"
+#include "externalqueue.h"
+
+using namespace std;
+
+
+/**
+ * Constructor: Create an empty queue using (about) 'mBytes' MBytes of main memory.
+ */
+ExternalQueue::ExternalQueue(unsigned long mBytes)
+{
+	prefix = "sokoban.ext";
+
+	// Half of the memory is used for the buffers of the threads, the other half for the
+	// stdio buffers while merging.
+	nThreads = omp_get_max_threads();
+	bufSize = (mBytes << 19) / nThreads / sizeof(confno_t);
+	if (bufSize < 1024)
+		bufSize = 1024;
+	buffer = new confno_t*[nThreads];
+	bufLen = new unsigned long[nThreads]();
+	for (unsigned int t=0; t<nThreads; t++)
+		buffer[t] = new confno_t[bufSize];
+	ioBufSize = mBytes << 19;
+
+	nRuns = 0;
+	depth = 0;
+	nVisited = 0;
+	layerIn = NULL;
+	omp_init_lock(&lock);
+	fclose(openFile(visitedName(0), "w"));
+}
+
+/**
+ * Destructor: delete all files and deallocate memory.
+ */
+ExternalQueue::~ExternalQueue()
+{
+	if (layerIn != NULL)
+		fclose(layerIn);
+	for (unsigned int d=0; d<depth; d++)
+		unlink(layerName(d).c_str());
+	unlink(visitedName(depth).c_str());
+	omp_destroy_lock(&lock);
+	for (unsigned int t=0; t<nThreads; t++)
+		delete[] buffer[t];
+	delete[] buffer;
+	delete[] bufLen;
+}
+
+/**
+ * Return the names of the files.
+ */
+string ExternalQueue::runName(unsigned int run)
+{
+	ostringstream s;
+	s << prefix << ".run" << run;
+	return s.str();
+}
+
+string ExternalQueue::layerName(unsigned int d)
+{
+	ostringstream s;
+	s << prefix << ".depth" << d;
+	return s.str();
+}
+
+string ExternalQueue::visitedName(unsigned int d)
+{
+	ostringstream s;
+	s << prefix << ".visited" << (d % 2);
+	return s.str();
+}
+
+/**
+ * Open the file 'fname'; 'mode' as for fopen().
+ */
+FILE * ExternalQueue::openFile(const string & fname, const char * mode)
+{
+	FILE * f = fopen(fname.c_str(), mode);
+	if (f == NULL) {
+		cerr << "Cannot open tmp file '" << fname << "'\n";
+		exit(1);
+	}
+	return f;
+}
+
+/**
+ * Sort the buffer of thread 't' and write it into a new run file.
+ */
+void ExternalQueue::flush(unsigned int t)
+{
+	if (bufLen[t] == 0)
+		return;
+	sort(buffer[t], buffer[t] + bufLen[t]);
+	FILE * f = openFile(runName(__sync_fetch_and_add(&nRuns, 1)), "w");
+	if (fwrite(buffer[t], sizeof(confno_t), bufLen[t], f) != bufLen[t]) {
+		cerr << "Cannot write tmp file\n";
+		exit(1);
+	}
+	fclose(f);
+	bufLen[t] = 0;
+}
+
+/**
+ * Add the configuration 'conf' to the next tree depth. Duplicates are only removed
+ * by pushDepth(). This method is thread-safe.
+ */
+void ExternalQueue::add(confno_t conf)
+{
+	unsigned int t = omp_get_thread_num();
+	buffer[t][bufLen[t]++] = conf;
+	if (bufLen[t] == bufSize)
+		flush(t);
+}
+
+/**
+ * Increase the tree depth by one: the configurations added since the last call (which
+ * have not been found before) become the current tree depth.
+ */
+void ExternalQueue::pushDepth()
+{
+	for (unsigned int t=0; t<nThreads; t++)
+		flush(t);
+	if (layerIn != NULL) {
+		fclose(layerIn);
+		layerIn = NULL;
+	}
+
+	// Open all runs, and the old and new file of all configurations found so far. Each
+	// file gets an equal share of the memory as stdio buffer.
+	unsigned long bufBytes = ioBufSize / (nRuns + 3);
+	if (bufBytes < 4096)
+		bufBytes = 4096;
+	vector<FILE *> runs(nRuns);
+	for (unsigned int r=0; r<nRuns; r++) {
+		runs[r] = openFile(runName(r), "r");
+		setvbuf(runs[r], NULL, _IOFBF, bufBytes);
+	}
+	FILE * oldVisited = openFile(visitedName(depth), "r");
+	FILE * newVisited = openFile(visitedName(depth+1), "w");
+	FILE * layer = openFile(layerName(depth), "w");
+	setvbuf(oldVisited, NULL, _IOFBF, bufBytes);
+	setvbuf(newVisited, NULL, _IOFBF, bufBytes);
+	setvbuf(layer, NULL, _IOFBF, bufBytes);
+
+	// k-way merge of the runs, using a heap with the smallest unread entry of each run
+	typedef pair<confno_t, unsigned int> Entry;
+	priority_queue<Entry, vector<Entry>, greater<Entry> > heap;
+	for (unsigned int r=0; r<nRuns; r++) {
+		confno_t c;
+		if (fread(&c, sizeof(confno_t), 1, runs[r]) == 1)
+			heap.push(Entry(c, r));
+	}
+	confno_t vis;
+	bool hasVis = (fread(&vis, sizeof(confno_t), 1, oldVisited) == 1);
+	unsigned long length = 0;
+	unsigned long visited = 0;
+	bool first = true;
+	confno_t last = 0;
+	while (!heap.empty()) {
+		Entry e = heap.top();
+		heap.pop();
+		confno_t c;
+		if (fread(&c, sizeof(confno_t), 1, runs[e.second]) == 1)
+			heap.push(Entry(c, e.second));
+		// Skip duplicates within the new tree depth
+		if (!first && (e.first == last))
+			continue;
+		first = false;
+		last = e.first;
+		// Copy the smaller configurations found before, and skip 'last' if it is one of them
+		while (hasVis && (vis < last)) {
+			fwrite(&vis, sizeof(confno_t), 1, newVisited);
+			visited++;
+			hasVis = (fread(&vis, sizeof(confno_t), 1, oldVisited) == 1);
+		}
+		if (hasVis && (vis == last))
+			continue;
+		fwrite(&last, sizeof(confno_t), 1, newVisited);
+		fwrite(&last, sizeof(confno_t), 1, layer);
+		visited++;
+		length++;
+	}
+	while (hasVis) {
+		fwrite(&vis, sizeof(confno_t), 1, newVisited);
+		visited++;
+		hasVis = (fread(&vis, sizeof(confno_t), 1, oldVisited) == 1);
+	}
+	if (ferror(newVisited) || ferror(layer)) {
+		cerr << "Cannot write tmp file\n";
+		exit(1);
+	}
+
+	// Clean up: the runs and the old file of all configurations are no longer needed
+	for (unsigned int r=0; r<nRuns; r++) {
+		fclose(runs[r]);
+		unlink(runName(r).c_str());
+	}
+	fclose(oldVisited);
+	fclose(newVisited);
+	fclose(layer);
+	unlink(visitedName(depth).c_str());
+	nRuns = 0;
+	nVisited = visited;
+	layerLength.push_back(length);
+
+	// Open the new tree depth for reading
+	layerIn = openFile(layerName(depth), "r");
+	setvbuf(layerIn, NULL, _IOFBF, ioBufSize);
+	depth++;
+}
+
+/**
+ * Return the number of configurations in the current tree depth.
+ */
+unsigned long ExternalQueue::length()
+{
+	return layerLength.back();
+}
+
+/**
+ * Read the next (at most) 'max' configurations of the current tree depth into 'confs'
+ * and return their number (0 at the end of the tree depth). This method is thread-safe.
+ */
+unsigned int ExternalQueue::read(confno_t confs[], unsigned int max)
+{
+	omp_set_lock(&lock);
+	unsigned int n = fread(confs, sizeof(confno_t), max, layerIn);
+	omp_unset_lock(&lock);
+	return n;
+}
+
+/**
+ * Return the path from the initial configuration to the configuration 'conf', which has
+ * been added while expanding the current tree depth. In '*length' the length of the path
+ * is returned. The result is allocated dynamically and should be deallocated using
+ * delete[].
+ */
+confno_t * ExternalQueue::getPath(confno_t conf, unsigned int * length)
+{
+	confno_t * path = new confno_t[depth+1];
+	path[depth] = conf;
+	for (unsigned int d=depth; d>0; d--) {
+		// Determine all predecessors of path[d] by pulling a box back, and search them in
+		// the (sorted) file of tree depth d-1
+		Config cur(path[d]);
+		vector<confno_t> pred;
+		for (unsigned int box=0; box<Config::numBoxes(); box++) {
+			for (unsigned int dir=0; dir<4; dir++) {
+				confno_t c = cur.getPrevConfig(box, dir);
+				if (c != Config::NONE)
+					pred.push_back(c);
+			}
+		}
+		sort(pred.begin(), pred.end());
+		FILE * f = openFile(layerName(d-1), "r");
+		setvbuf(f, NULL, _IOFBF, ioBufSize);
+		confno_t c;
+		bool found = false;
+		unsigned int i = 0;
+		while (!found && (i < pred.size()) && (fread(&c, sizeof(confno_t), 1, f) == 1)) {
+			while ((i < pred.size()) && (pred[i] < c))
+				i++;
+			found = (i < pred.size()) && (pred[i] == c);
+		}
+		fclose(f);
+		if (!found) {
+			cerr << "FATAL ERROR: No predecessor found for the solution path!\n";
+			exit(1);
+		}
+		path[d-1] = c;
+	}
+	*length = depth + 1;
+	return path;
+}
+
+/**
+ * Returns information about RAM and hard disk usage.
+ */
+void ExternalQueue::statistics()
+{
+	unsigned long disk = nVisited;
+	for (unsigned int d=0; d<depth; d++)
+		disk += layerLength[d];
+	cout << "Used " << (nThreads * bufSize * sizeof(confno_t) + ioBufSize) / 1024
+		 << " KBytes for buffers\n";
+	cout << "Used " << disk * sizeof(confno_t) / 1024 << " KBytes on disk\n";
+}
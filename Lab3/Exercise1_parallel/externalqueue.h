@@ -0,0 +1,107 @@
+using namespace std;
+
+/**
+ * Queue for an external-memory breadth first search with delayed duplicate detection. In
+ * contrast to BFSQueue, neither the configurations found so far nor the tree depths are kept
+ * in main memory, so the memory needed does not depend on the number of configurations, but
+ * only on the given budget:
+ *  - The configurations found while expanding a tree depth are collected in a buffer per
+ *    thread. When a buffer is full, it is sorted and written to a 'run' file.
+ *  - When the tree depth is complete (pushDepth()), all runs are merged with a k-way merge,
+ *    which removes the duplicates. The result is merged with the sorted file of all
+ *    configurations found before, which yields the configurations of the new tree depth
+ *    (i.e., those not found before) and the new file of all configurations.
+ * The push graph of Sokoban is directed, so a configuration may be found again much later;
+ * thus, the duplicates are removed with respect to all previous tree depths, not just the
+ * last two. Each tree depth is kept in its own sorted file, so the solution path can be
+ * determined backwards using Config::getPrevConfig() (see getPath()).
+ */
+class ExternalQueue
+{
+ private:
+	// Prefix of the names of all files
+	string prefix;
+
+	// Buffers of the threads, their capacity and their lengths
+	unsigned int nThreads;
+	confno_t ** buffer;
+	unsigned long bufSize;
+	unsigned long * bufLen;
+
+	// Size of the stdio buffer of a file during a merge (in bytes)
+	unsigned long ioBufSize;
+
+	// Number of run files written for the current tree depth
+	volatile unsigned int nRuns;
+
+	// Current tree depth, and number of configurations in each tree depth
+	unsigned int depth;
+	vector<unsigned long> layerLength;
+
+	// Number of configurations in the file of all configurations found so far
+	unsigned long nVisited;
+
+	// The file of the current tree depth while it is read by read(), and the lock
+	// protecting it. The threads may wait for the disk while holding the lock, so it is
+	// no spin lock.
+	FILE * layerIn;
+	omp_lock_t lock;
+
+	// Return the names of the files.
+	string runName(unsigned int run);
+	string layerName(unsigned int d);
+	string visitedName(unsigned int d);
+
+	// Open the file 'fname'; 'mode' as for fopen().
+	FILE * openFile(const string & fname, const char * mode);
+
+	// Sort the buffer of thread 't' and write it into a new run file.
+	void flush(unsigned int t);
+
+ public:
+	/**
+	 * Constructor: Create an empty queue using (about) 'mBytes' MBytes of main memory.
+	 */
+	ExternalQueue(unsigned long mBytes);
+
+	/**
+	 * Destructor: delete all files and deallocate memory.
+	 */
+	~ExternalQueue();
+
+	/**
+	 * Add the configuration 'conf' to the next tree depth. Duplicates are only removed
+	 * by pushDepth(). This method is thread-safe.
+	 */
+	void add(confno_t conf);
+
+	/**
+	 * Increase the tree depth by one: the configurations added since the last call (which
+	 * have not been found before) become the current tree depth.
+	 */
+	void pushDepth();
+
+	/**
+	 * Return the number of configurations in the current tree depth.
+	 */
+	unsigned long length();
+
+	/**
+	 * Read the next (at most) 'max' configurations of the current tree depth into 'confs'
+	 * and return their number (0 at the end of the tree depth). This method is thread-safe.
+	 */
+	unsigned int read(confno_t confs[], unsigned int max);
+
+	/**
+	 * Return the path from the initial configuration to the configuration 'conf', which has
+	 * been added while expanding the current tree depth. In '*length' the length of the path
+	 * is returned. The result is allocated dynamically and should be deallocated using
+	 * delete[].
+	 */
+	confno_t * getPath(confno_t conf, unsigned int * length);
+
+	/**
+	 * Returns information about RAM and hard disk usage.
+	 */
+	void statistics();
+};
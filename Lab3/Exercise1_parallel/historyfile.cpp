@@ -0,0 +1,134 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <iostream>
+
+#include "historyfile.h"
+
+using namespace std;
+
+/**
+ * Append-only, memory-mapped temporary file storing the queue entries of the tree depths that
+ * are no longer needed for the search itself, but for determining the solution path.
+ */
+
+
+/**
+ * Constructor: Create the temporary file 'fname'. The file is deleted immediately, but
+ * stays accessible until the object is destroyed.
+ */
+HistoryFile::HistoryFile(const char * fname)
+{
+	init(fname, false);
+}
+
+/**
+ * Constructor: Open the file 'fname', which is kept after the object is destroyed (for
+ * checkpoints, see BFSQueue). An existing file is not truncated, so its contents can be
+ * used again with resume().
+ */
+HistoryFile::HistoryFile(const char * fname, bool keep)
+{
+	init(fname, keep);
+}
+
+/**
+ * Open and map the file 'fname'. If 'keep' is false, the file is truncated and deleted.
+ */
+void HistoryFile::init(const char * fname, bool keep)
+{
+	fd = open(fname, keep ? O_RDWR|O_CREAT : O_RDWR|O_CREAT|O_TRUNC, 0600);
+	if (fd < 0) {
+		cerr << "Cannot open tmp file '" << fname << "'\n";
+		exit(1);
+	}
+	// Delete the file. However, it stays accessible until it is closed.
+	if (!keep)
+		unlink(fname);
+
+	// The mapping covers the whole file (at least INITSIZE bytes)
+	struct stat st;
+	fstat(fd, &st);
+	capacity = INITSIZE;
+	while (capacity < (unsigned long)st.st_size)
+		capacity *= 2;
+	used = 0;
+	if (ftruncate(fd, capacity) != 0) {
+		cerr << "Cannot enlarge tmp file '" << fname << "'\n";
+		exit(1);
+	}
+	base = (char *)mmap(NULL, capacity, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		cerr << "Cannot map tmp file '" << fname << "'\n";
+		exit(1);
+	}
+	// Note: no madvise(MADV_SEQUENTIAL) here. The read-ahead it triggers on each write
+	// fault makes appending noticeably slower.
+}
+
+/**
+ * Destructor: unmap and close the file.
+ */
+HistoryFile::~HistoryFile()
+{
+	munmap(base, capacity);
+	close(fd);
+}
+
+/**
+ * Append 'bytes' bytes from 'data' at the end of the file.
+ */
+void HistoryFile::append(const void * data, unsigned long bytes)
+{
+	if (used + bytes > capacity)
+		grow(used + bytes);
+	memcpy(base + used, data, bytes);
+	used += bytes;
+}
+
+/**
+ * Continue with a file of which the first 'length' bytes have been written before
+ * (e.g., by a previous run of the program). Everything behind is overwritten.
+ */
+void HistoryFile::resume(unsigned long length)
+{
+	if (length > capacity)
+		grow(length);
+	used = length;
+}
+
+/**
+ * Write all changes of the mapping to the disk.
+ */
+void HistoryFile::sync()
+{
+	if (msync(base, used, MS_SYNC) != 0) {
+		cerr << "Cannot write tmp file\n";
+		exit(1);
+	}
+}
+
+/**
+ * Enlarge the file and the mapping to at least 'size' bytes.
+ */
+void HistoryFile::grow(unsigned long size)
+{
+	unsigned long newCapacity = 2 * capacity;
+	while (newCapacity < size)
+		newCapacity *= 2;
+	if (ftruncate(fd, newCapacity) != 0) {
+		cerr << "Cannot enlarge tmp file\n";
+		exit(1);
+	}
+	base = (char *)mremap(base, capacity, newCapacity, MREMAP_MAYMOVE);
+	if (base == MAP_FAILED) {
+		cerr << "Cannot map tmp file\n";
+		exit(1);
+	}
+	capacity = newCapacity;
+}
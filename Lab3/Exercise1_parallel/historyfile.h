@@ -0,0 +1,79 @@
+using namespace std;
+
+/**
+ * Append-only, memory-mapped temporary file storing the queue entries of the tree depths that
+ * are no longer needed for the search itself, but for determining the solution path (see
+ * BFSQueue). The file is mapped into the address space as a whole, so the entries are written
+ * by copying them into the mapping, and read back by simple pointer accesses; the operating
+ * system transfers the pages between the page cache and the disk. When the file is full, it is
+ * enlarged (ftruncate) and the mapping is extended (mremap).
+ */
+class HistoryFile
+{
+ private:
+	int fd;                     // File descriptor of the (deleted) file
+	char * base;                // Start of the mapping
+	unsigned long capacity;     // Size of the file and the mapping in bytes
+	unsigned long used;         // Number of bytes written so far
+
+	// Initial size of the file, it is doubled whenever it is full
+	static const unsigned long INITSIZE = 64UL << 20;
+
+	// Enlarge the file and the mapping to at least 'size' bytes.
+	void grow(unsigned long size);
+
+	// Open and map the file 'fname'. If 'keep' is false, the file is truncated and deleted.
+	void init(const char * fname, bool keep);
+
+ public:
+	/**
+	 * Constructor: Create the temporary file 'fname'. The file is deleted immediately, but
+	 * stays accessible until the object is destroyed.
+	 */
+	HistoryFile(const char * fname);
+
+	/**
+	 * Constructor: Open the file 'fname', which is kept after the object is destroyed (for
+	 * checkpoints, see BFSQueue). An existing file is not truncated, so its contents can be
+	 * used again with resume().
+	 */
+	HistoryFile(const char * fname, bool keep);
+
+	/**
+	 * Destructor: unmap and close the file.
+	 */
+	~HistoryFile();
+
+	/**
+	 * Append 'bytes' bytes from 'data' at the end of the file.
+	 */
+	void append(const void * data, unsigned long bytes);
+
+	/**
+	 * Continue with a file of which the first 'length' bytes have been written before
+	 * (e.g., by a previous run of the program). Everything behind is overwritten.
+	 */
+	void resume(unsigned long length);
+
+	/**
+	 * Write all changes of the mapping to the disk.
+	 */
+	void sync();
+
+	/**
+	 * Return a pointer to the byte at position 'offset' of the file. The pointer is only
+	 * valid until the next call of append().
+	 */
+	inline const void * at(unsigned long offset)
+	{
+		return base + offset;
+	}
+
+	/**
+	 * Return the number of bytes written so far.
+	 */
+	inline unsigned long length()
+	{
+		return used;
+	}
+};
@@ -0,0 +1,152 @@
+#include <stdlib.h>
+
+#include <iostream>
+
+#include "confno.h"
+#include "playfield.h"
+#include "lowerbound.h"
+
+using namespace std;
+
+
+unsigned int * LowerBound::dist;       // Number of pushes from each field to each target
+unsigned int   LowerBound::nPos;       // Number of fields that may contain a box
+unsigned int   LowerBound::nBox;       // Number of boxes and targets
+
+/**
+ * Initialize the class using the playing field (see Playfield::init()).
+ */
+void LowerBound::init()
+{
+	nPos = Playfield::nPos;
+	nBox = Playfield::nBox;
+	dist = new unsigned int[nBox * nPos];
+
+	// For each target, determine the distances by a breadth first search that pulls a
+	// single box away from the target: the box can be pushed from field 'p' to its neighbor
+	// 'q' in direction 'dir', if the player can stand on the neighbor of 'p' in direction
+	// dir^2 and 'p' is no dead-end.
+	unsigned int queue[nPos];
+	for (unsigned int g=0; g<nBox; g++) {
+		unsigned int * d = &dist[g*nPos];
+		for (unsigned int p=0; p<nPos; p++)
+			d[p] = UNREACHABLE;
+		d[g] = 0;
+		queue[0] = g;
+		unsigned int len = 1;
+		for (unsigned int i=0; i<len; i++) {
+			unsigned int q = queue[i];
+			for (unsigned int dir=0; dir<4; dir++) {
+				unsigned int p = Playfield::neighbor[dir^2][q];
+				if (!Playfield::isValid(p) || Playfield::isDead(p) || (d[p] != UNREACHABLE)
+					|| !Playfield::isValid(Playfield::neighbor[dir^2][p]))
+					continue;
+				d[p] = d[q] + 1;
+				queue[len++] = p;
+			}
+		}
+	}
+}
+
+/**
+ * Return the lower bound for the box positions in 'boxPos' (numBoxes() entries), or
+ * INFINITE if the boxes can not be moved onto the targets. The optimal assignment is
+ * stored in '*a'.
+ */
+unsigned int LowerBound::estimate(const unsigned int boxPos[], Assignment * a)
+{
+	// Hungarian method: start with an empty assignment and add the rows one by one
+	for (unsigned int j=0; j<=nBox; j++) {
+		a->u[j] = a->v[j] = 0;
+		a->p[j] = 0;
+	}
+	for (unsigned int i=1; i<=nBox; i++)
+		augment(boxPos, i, a);
+	return cost(boxPos, a);
+}
+
+/**
+ * Like estimate(), but the box positions 'boxPos' differ from the ones of the assignment
+ * 'from' only in the position of box 'box' (e.g., after a push). '*a' is computed from
+ * 'from' with a single augmenting path instead of solving the assignment problem anew.
+ */
+unsigned int LowerBound::update(const unsigned int boxPos[], unsigned int box,
+								const Assignment & from, Assignment * a)
+{
+	// The potentials remain feasible for all other rows, whose costs have not changed.
+	// augment() adjusts the potential of the moved box to its new costs.
+	*a = from;
+	unsigned int i = box + 1;
+	for (unsigned int j=1; j<=nBox; j++) {
+		if (a->p[j] == i)
+			a->p[j] = 0;
+	}
+	augment(boxPos, i, a);
+	return cost(boxPos, a);
+}
+
+// Add the row 'i' to the assignment '*a', in which no column is assigned to it, with a
+// shortest augmenting path. The costs of the row are given by 'boxPos'.
+void LowerBound::augment(const unsigned int boxPos[], unsigned int i, Assignment * a)
+{
+	// way[j] is the previous column on the augmenting path, column 0 stands for row 'i'
+	const int INF = 1 << 30;
+	unsigned int n = nBox;
+	int * u = a->u;
+	int * v = a->v;
+	unsigned int * p = a->p;
+	int minv[n+1];
+	unsigned int way[n+1];
+	bool used[n+1];
+	p[0] = i;
+	unsigned int j0 = 0;
+	for (unsigned int j=0; j<=n; j++) {
+		minv[j] = INF;
+		used[j] = false;
+	}
+	do {
+		used[j0] = true;
+		unsigned int i0 = p[j0];
+		unsigned int row = boxPos[i0-1];
+		int delta = INF;
+		unsigned int j1 = 0;
+		for (unsigned int j=1; j<=n; j++) {
+			if (used[j])
+				continue;
+			int cur = (int)dist[(j-1)*nPos + row] - u[i0] - v[j];
+			if (cur < minv[j]) {
+				minv[j] = cur;
+				way[j] = j0;
+			}
+			if (minv[j] < delta) {
+				delta = minv[j];
+				j1 = j;
+			}
+		}
+		for (unsigned int j=0; j<=n; j++) {
+			if (used[j]) {
+				u[p[j]] += delta;
+				v[j] -= delta;
+			}
+			else {
+				minv[j] -= delta;
+			}
+		}
+		j0 = j1;
+	} while (p[j0] != 0);
+	// Augment along the path
+	do {
+		unsigned int j1 = way[j0];
+		p[j0] = p[j1];
+		j0 = j1;
+	} while (j0 != 0);
+}
+
+// Return the lower bound for the assignment '*a' of the box positions 'boxPos'.
+unsigned int LowerBound::cost(const unsigned int boxPos[], const Assignment * a)
+{
+	unsigned int cost = 0;
+	for (unsigned int j=1; j<=nBox; j++)
+		cost += dist[(j-1)*nPos + boxPos[a->p[j]-1]];
+	return (cost >= UNREACHABLE) ? INFINITE : cost;
+}
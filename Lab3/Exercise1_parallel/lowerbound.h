@@ -0,0 +1,76 @@
+/**
+ * This class (with only static attributes and methods) computes a lower bound for the number
+ * of pushes needed to move all boxes onto the targets. For each target and each field, the
+ * number of pushes needed to move a single box from the field onto the target is precomputed,
+ * ignoring all other boxes. The lower bound is the minimum cost of an assignment of the boxes
+ * to the targets (i.e., a perfect matching), which is determined with the Hungarian method.
+ * The bound never decreases by more than one with a single push, so it is consistent.
+ * A push only changes the costs of a single box. So, the assignment of a successor is
+ * computed from the assignment of its predecessor (see update()) by removing the moved box
+ * from the assignment and adding it again with a single augmenting path.
+ */
+class LowerBound
+{
+ private:
+	// dist[g*nPos + p] contains the number of pushes needed to move a box from field 'p' onto
+	// the target 'g', or UNREACHABLE.
+	static unsigned int * dist;
+
+	// Number of fields that may contain a box (see Playfield::nPos)
+	static unsigned int nPos;
+
+	// Number of boxes and targets
+	static unsigned int nBox;
+
+	// Cost of an assignment that is not possible. It is larger than the cost of any
+	// possible assignment of all boxes.
+	static const unsigned int UNREACHABLE = 1 << 20;
+
+ public:
+	// Maximum number of boxes (as in Config)
+	static const unsigned int MAXBOX = 24;
+
+	/**
+	 * Solution of the assignment problem for a set of box positions (see estimate()): the
+	 * boxes are the rows 1 ... n, the targets the columns 1 ... n. u and v are the
+	 * potentials of the Hungarian method, p[j] is the row assigned to column j.
+	 */
+	struct Assignment {
+		int u[MAXBOX+1];
+		int v[MAXBOX+1];
+		unsigned int p[MAXBOX+1];
+	};
+
+	/**
+	 * Value returned by estimate(), if (at least) one box can not reach any target.
+	 */
+	static const unsigned int INFINITE = -1;
+
+	/**
+	 * Initialize the class using the playing field (see Playfield::init()).
+	 */
+	static void init();
+
+	/**
+	 * Return the lower bound for the box positions in 'boxPos' (numBoxes() entries), or
+	 * INFINITE if the boxes can not be moved onto the targets. The optimal assignment is
+	 * stored in '*a'.
+	 */
+	static unsigned int estimate(const unsigned int boxPos[], Assignment * a);
+
+	/**
+	 * Like estimate(), but the box positions 'boxPos' differ from the ones of the assignment
+	 * 'from' only in the position of box 'box' (e.g., after a push). '*a' is computed from
+	 * 'from' with a single augmenting path instead of solving the assignment problem anew.
+	 */
+	static unsigned int update(const unsigned int boxPos[], unsigned int box,
+							   const Assignment & from, Assignment * a);
+
+ private:
+	// Add the row 'i' to the assignment '*a', in which no column is assigned to it, with a
+	// shortest augmenting path. The costs of the row are given by 'boxPos'.
+	static void augment(const unsigned int boxPos[], unsigned int i, Assignment * a);
+
+	// Return the lower bound for the assignment '*a' of the box positions 'boxPos'.
+	static unsigned int cost(const unsigned int boxPos[], const Assignment * a);
+};
@@ -0,0 +1,62 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <iostream>
+
+#include "mappedarray.h"
+
+using namespace std;
+
+/**
+ * Large array of zero-initialized memory, which is reserved as a whole with a single
+ * anonymous mapping (mmap with MAP_NORESERVE).
+ */
+
+
+bool MappedArray::hugePages = false;
+
+/**
+ * Constructor: Reserve an array of 'bytes' bytes, all initialized with 0.
+ */
+MappedArray::MappedArray(unsigned long bytes)
+{
+	this->bytes = (bytes > 0) ? bytes : 1;
+	base = (char *)mmap(NULL, this->bytes, PROT_READ|PROT_WRITE,
+						MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+	if (base == MAP_FAILED) {
+		cerr << "Error: cannot reserve " << (this->bytes >> 20) << " MBytes of address space\n";
+		exit(1);
+	}
+#ifdef MADV_HUGEPAGE
+	// Only a hint: if the system does not support huge pages, normal pages are used
+	if (hugePages)
+		madvise(base, this->bytes, MADV_HUGEPAGE);
+#endif
+}
+
+/**
+ * Destructor: unmap the array.
+ */
+MappedArray::~MappedArray()
+{
+	munmap(base, bytes);
+}
+
+/**
+ * Return the number of KBytes of the array actually residing in main memory
+ * (determined with mincore()).
+ */
+unsigned long MappedArray::resident()
+{
+	unsigned long pageSize = sysconf(_SC_PAGESIZE);
+	unsigned long nPages = (bytes + pageSize - 1) / pageSize;
+	unsigned char * vec = new unsigned char[nPages];
+	unsigned long n = 0;
+	if (mincore(base, bytes, vec) == 0) {
+		for (unsigned long i=0; i<nPages; i++)
+			n += vec[i] & 1;
+	}
+	delete[] vec;
+	return n * (pageSize / 1024);
+}
@@ -0,0 +1,48 @@
+using namespace std;
+
+/**
+ * Large array of zero-initialized memory, which is reserved as a whole with a single
+ * anonymous mapping (mmap with MAP_NORESERVE). Thus, the array can cover the whole range of
+ * configuration numbers: the operating system only allocates a page when it is accessed
+ * for the first time, and pages that are only read map to a shared zero page. In contrast
+ * to a two-level array, an access needs neither a NULL check nor a second pointer access,
+ * and no blocks must be installed atomically.
+ */
+class MappedArray
+{
+ private:
+	char * base;                // Start of the mapping
+	unsigned long bytes;        // Size of the mapping in bytes
+
+ public:
+	/**
+	 * Use transparent huge pages for the mapping (madvise(MADV_HUGEPAGE)), if supported by
+	 * the system. This reduces the TLB misses of the random accesses, but the memory is
+	 * allocated in larger units.
+	 */
+	static bool hugePages;
+
+	/**
+	 * Constructor: Reserve an array of 'bytes' bytes, all initialized with 0.
+	 */
+	MappedArray(unsigned long bytes);
+
+	/**
+	 * Destructor: unmap the array.
+	 */
+	~MappedArray();
+
+	/**
+	 * Return the start of the array.
+	 */
+	inline void * data()
+	{
+		return base;
+	}
+
+	/**
+	 * Return the number of KBytes of the array actually residing in main memory
+	 * (determined with mincore()).
+	 */
+	unsigned long resident();
+};
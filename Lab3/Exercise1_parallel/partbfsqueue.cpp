@@ -0,0 +1,286 @@
+#include <stdlib.h>
+
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "confno.h"
+#include "confighashmap.h"
+#include "historyfile.h"
+#include "partbfsqueue.h"
+
+using namespace std;
+
+/**
+ * Data structure for an owner-partitioned parallel breadth first search. Like BFSQueue, it
+ * implements a queue for configurations, connected with a bit set storing the configurations
+ * that have already been visited. However, the range of configuration numbers is split into
+ * 'nParts' partitions, one per thread. Each partition owns its part of the bit set and its own
+ * read and write queues, so it is only accessed by a single thread.
+ */
+
+
+/**
+ * Constructor: Create a queue/bit set for configuration numbers between
+ * 0 and numConf-1, which is split into 'nParts' partitions.
+ */
+PartBFSQueue::PartBFSQueue(confno_t numConf, unsigned int anParts)
+	: file("sokoban.tmp") // open a temporary file
+{
+	nParts = anParts;
+	// A partition holds at most all configurations of the chunks it owns. If the bit sets
+	// do not fit into the main memory, each partition uses a hash map instead.
+	bool dense = ConfigHashMap::fitsDense(numConf / 8);
+	queue_length = qIndex1(((numConf < MAXLENGTH) ? (unsigned long)numConf : MAXLENGTH) - 1) + 1;
+	bitset_length = dense ? bsIndex1(localConf(numConf-1)) + 1 : 0;
+	parts = new Partition[nParts];
+	for (unsigned int p=0; p<nParts; p++) {
+		parts[p].queue[0] = new Entry *[queue_length]();
+		parts[p].queue[1] = new Entry *[queue_length]();
+		parts[p].bitset = new unsigned int *[bitset_length]();
+		parts[p].hashed = dense ? NULL : new ConfigHashMap();
+		parts[p].outbox = new vector<Entry>[nParts];
+		parts[p].wrPos = 0;
+		parts[p].rdLength = 0;
+		parts[p].rdOffset = 0;
+	}
+	depth = 0;
+	file_length = 0;
+}
+
+/**
+ * Destructor: deallocate memory.
+ */
+PartBFSQueue::~PartBFSQueue()
+{
+	for (unsigned int p=0; p<nParts; p++) {
+		for (unsigned int i=0; i<queue_length; i++) {
+			delete[] parts[p].queue[0][i];
+			delete[] parts[p].queue[1][i];
+		}
+		for (unsigned int i=0; i<bitset_length; i++) {
+			delete[] parts[p].bitset[i];
+		}
+		delete[] parts[p].queue[0];
+		delete[] parts[p].queue[1];
+		delete[] parts[p].bitset;
+		delete parts[p].hashed;
+		delete[] parts[p].outbox;
+	}
+	delete[] parts;
+}
+
+/**
+ * Enter the start configuration. Must be called before the first call of pushDepth().
+ */
+void PartBFSQueue::init(confno_t conf)
+{
+	lookup_and_add(owner(conf), conf, -1, 0);
+}
+
+/**
+ * Increase the tree depth by one. The previous write queues become the read queues for the
+ * new tree depth. The old read queues are stored in a temporary file to determine the
+ * solution path at the end. Must be called by a single thread.
+ */
+void PartBFSQueue::pushDepth()
+{
+	unsigned int wr = depth % 2;
+	unsigned long offset = 0;
+
+	// Export the old read queues to the file, ordered by partition. This defines the
+	// global index of each entry.
+	layerStart.push_back(file_length);
+	for (unsigned int p=0; p<nParts; p++) {
+		Partition * part = &parts[p];
+		unsigned int n1 = qIndex1(part->wrPos);
+		unsigned int n2 = qIndex2(part->wrPos);
+		for (unsigned int i=0; i<n1; i++)
+			file.append(part->queue[wr][i], BLOCKSIZE * sizeof(Entry));
+		if (n2 > 0)
+			file.append(part->queue[wr][n1], n2 * sizeof(Entry));
+		file_length += part->wrPos;
+
+		part->rdOffset = offset;
+		part->rdLength = part->wrPos;
+		part->wrPos = 0;
+		offset += part->rdLength;
+	}
+	depth++;
+}
+
+/**
+ * Send a successor configuration from partition 'from' to the partition owning it.
+ * 'predIndex' is the index of the predecessor configuration in the read queue of 'from',
+ * 'box' the number of the moved box. Must only be called by the thread owning 'from'.
+ */
+void PartBFSQueue::send(unsigned int from, confno_t conf, unsigned int predIndex,
+						unsigned int box)
+{
+	Entry msg;
+	msg.set(conf, parts[from].rdOffset + predIndex, box);
+	parts[from].outbox[owner(conf)].push_back(msg);
+}
+
+/**
+ * Receive all messages sent to partition 'part' and enter the configurations that have
+ * not been visited before into its write queue. If one of these configurations satisfies
+ * 'isGoal', 'true' is returned, and the configuration and the global index of its
+ * predecessor are stored in '*goal' and '*goalPred'. Must only be called by the thread
+ * owning 'part', and only when no thread is sending.
+ */
+bool PartBFSQueue::receive(unsigned int part, bool (*isGoal)(confno_t),
+						   confno_t * goal, unsigned int * goalPred)
+{
+	bool found = false;
+	for (unsigned int from=0; from<nParts; from++) {
+		vector<Entry> & inbox = parts[from].outbox[part];
+		for (unsigned int i=0; i<inbox.size(); i++) {
+			Entry & msg = inbox[i];
+			if (lookup_and_add(part, msg.config, msg.pred, msg.box)
+				&& !found && isGoal(msg.config)) {
+				*goal = msg.config;
+				*goalPred = msg.pred;
+				found = true;
+			}
+		}
+		inbox.clear();
+	}
+	return found;
+}
+
+/**
+ * Checks if the given configuration is already contained in the bit set of partition
+ * 'part'. If not, the configuration is entered in the bit set and appended to the write
+ * queue of 'part'. Must only be called by the thread owning 'part'.
+ */
+bool PartBFSQueue::lookup_and_add(unsigned int part, confno_t conf, unsigned int pred,
+								  unsigned int box)
+{
+	Partition * p = &parts[part];
+	if (p->hashed != NULL) {
+		// If the configuration is in the hash map: we are done. Otherwise it is entered.
+		if (!p->hashed->lookup_and_set(conf, 1, NULL))
+			return false;
+	}
+	else {
+		confno_t local = localConf(conf);
+		unsigned int bitmask = 1 << bsBitPos(local);
+		unsigned int i1 = bsIndex1(local);
+		unsigned int i2 = bsIndex2(local);
+
+		// If necessary, allocate an array at the second level and initialize it with 0
+		if (p->bitset[i1] == NULL)
+			p->bitset[i1] = new unsigned int[BLOCKSIZE]();
+
+		// If the configuration is in the bit set: we are done
+		if ((p->bitset[i1][i2] & bitmask) != 0)
+			return false;
+
+		// add the configuration to the bit set
+		p->bitset[i1][i2] |= bitmask;
+	}
+
+	// Append the configuration, the global index of the predecessor configuration and
+	// the number of the moved box at the end of the write queue.
+	unsigned int wr = depth % 2;
+	unsigned int n1 = qIndex1(p->wrPos);
+	unsigned int n2 = qIndex2(p->wrPos);
+
+	// If necessary, allocate an array at the second level and initialize it
+	if (p->queue[wr][n1] == NULL)
+		p->queue[wr][n1] = new Entry[BLOCKSIZE]();
+
+	p->queue[wr][n1][n2].set(conf, pred, box);
+	p->wrPos++;
+
+	return true;
+}
+
+/**
+ * Return the total length of the read queues.
+ */
+unsigned long PartBFSQueue::length()
+{
+	unsigned long len = 0;
+	for (unsigned int p=0; p<nParts; p++)
+		len += parts[p].rdLength;
+	return len;
+}
+
+/**
+ * Return the length of the read queue of partition 'part'.
+ */
+unsigned int PartBFSQueue::length(unsigned int part)
+{
+	return parts[part].rdLength;
+}
+
+/**
+ * Return the i-th entry in the read queue of partition 'part' (configuration as return
+ * value; moved box in *box).
+ */
+confno_t PartBFSQueue::get(unsigned int part, unsigned int i, unsigned int * box)
+{
+	unsigned int rd = (depth-1) % 2;
+	Entry *e = &parts[part].queue[rd][qIndex1(i)][qIndex2(i)];
+	if (box != NULL)
+		*box = e->box;
+	return e->config;
+}
+
+/**
+ * Return the solution path as an array of configurations. The parameter conf is the
+ * solution configuration, predIndex the global index of the predecessor configuration.
+ * In *path_length the length of the path is returned. The result is allocated dynamically
+ * and should be deallocated using delete[].
+ */
+confno_t * PartBFSQueue::getPath(confno_t conf, unsigned int predIndex,
+									  unsigned int * path_length)
+{
+	confno_t * path = new confno_t[depth+1];
+	path[depth] = conf;
+	unsigned int pos = predIndex;
+	const Entry * entries = (const Entry *)file.at(0);
+
+	// Iterate the path in reversed order
+	for (int k = depth-1; k>=0; k--) {
+		// The entry for the predecessor configuration in the file
+		const Entry * e = &entries[layerStart[k] + pos];
+		path[k] = e->config;
+		pos = e->pred;
+	}
+	*path_length = depth+1;
+	return path;
+}
+
+/**
+ * Returns information about RAM and hard disk usage.
+ */
+void PartBFSQueue::statistics()
+{
+	unsigned long size = 0;
+	unsigned long bsSize = 0;
+	for (unsigned int p=0; p<nParts; p++) {
+		size += 2*queue_length*sizeof(Entry *)/1024;
+		for (unsigned int i=0; i<queue_length; i++) {
+			if (parts[p].queue[0][i] != NULL)
+				size += BLOCKSIZE/1024*sizeof(Entry);
+			if (parts[p].queue[1][i] != NULL)
+				size += BLOCKSIZE/1024*sizeof(Entry);
+		}
+		bsSize += bitset_length*sizeof(unsigned int *)/1024;
+		for (unsigned int i=0; i<bitset_length; i++) {
+			if (parts[p].bitset[i] != NULL)
+				bsSize += BLOCKSIZE/1024*sizeof(unsigned int);
+		}
+		if (parts[p].hashed != NULL)
+			bsSize += parts[p].hashed->memory();
+	}
+	cout << "Used " << size << " KBytes for arrays\n";
+	cout << "Used " << bsSize << " KBytes for " << ((bitset_length > 0) ? "bit set" : "hash maps")
+		 << "\n";
+
+	size = file_length*sizeof(Entry)/1024;
+	cout << "Used " << size << " KBytes for temp file\n";
+}
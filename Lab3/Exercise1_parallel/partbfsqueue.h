@@ -0,0 +1,215 @@
+using namespace std;
+
+/**
+ * Data structure for an owner-partitioned parallel breadth first search. Like BFSQueue, it
+ * implements a queue for configurations, connected with a bit set storing the configurations
+ * that have already been visited. However, the range of configuration numbers is split into
+ * 'nParts' partitions, one per thread. Each partition owns its part of the bit set and its own
+ * read and write queues, so it is only accessed by a single thread.
+ * Successor configurations are not entered directly, but sent as messages to the owning
+ * partition (send()). After a barrier, each thread receives the messages sent to its
+ * partition (receive()) and checks them against its local bit set. Thus, every access to the
+ * bit set is local, lock-free and does not share cache lines with other threads.
+ */
+class PartBFSQueue
+{
+ private:
+	/*
+	 * Class for an entry in the queue and for a message. Each entry contains:
+	 * - the number of the configuration
+	 * - the global index of the predecessor configuration in the previous tree depth
+	 *   (this is needed to determine the solution path when a solution has been found)
+	 * - the number of the box that was moved to reach this configuration
+	 *   (this is used to preferrably move the same box with the next move)
+	 */
+	class Entry {
+	public:
+		confno_t config;
+		unsigned int pred;
+		unsigned int box;
+
+		inline void set(confno_t aconfig, unsigned int apred, unsigned int abox) {
+			config = aconfig;
+			pred = apred;
+			box = abox;
+		}
+	};
+
+	/*
+	 * The data owned by one partition (i.e., one thread).
+	 */
+	class Partition {
+	public:
+		// Split queue, as in BFSQueue. The queues only contain configurations owned by
+		// this partition.
+		Entry ** queue[2];
+
+		// Position of the next free entry in the write queue
+		unsigned long wrPos;
+
+		// Length of the read queue
+		unsigned int rdLength;
+
+		// Global index of the first entry of the read queue within its tree depth.
+		// The entries of a tree depth are numbered consecutively, starting with the
+		// entries of partition 0.
+		unsigned long rdOffset;
+
+		// The bit set of the configurations owned by this partition, indexed by their local
+		// numbers (see localConf()).
+		unsigned int ** bitset;
+
+		// Hash map replacing the bit set if the range of configuration numbers is too
+		// large for a bit set (see BFSQueue), otherwise NULL.
+		ConfigHashMap * hashed;
+
+		// Outgoing messages, one buffer for each destination partition
+		vector<Entry> * outbox;
+
+		// Padding to avoid false sharing between partitions
+		char pad[64];
+	};
+
+	// Number of partitions
+	unsigned int nParts;
+
+	// The partitions
+	Partition * parts;
+
+	// Length of the first-level queue arrays of each partition
+	unsigned int queue_length;
+
+	// Length of the first-level bit set array of each partition
+	unsigned int bitset_length;
+
+	// Current tree depth
+	unsigned int depth;
+
+	// Swap file, see BFSQueue. The entries of each tree depth are stored in the order of
+	// their global index, i.e., ordered by partition.
+	HistoryFile     file;
+
+	// Number of entries in the swap file
+	unsigned long   file_length;
+
+	// Index of the first entry of each tree depth in the swap file
+	vector<unsigned long> layerStart;
+
+
+	// The queues and bit sets are allocated block by block, exactly like in BFSQueue.
+
+	static const unsigned int BLOCKBITS = 16;                 // 16 Bit, arrays with 65536 int's
+	static const unsigned int BLOCKSIZE = (1<<BLOCKBITS);     // Block size for allocation: 2^16
+	static const unsigned int BLOCKMASK = ((1<<BLOCKBITS)-1); // Bit mask where the last 16 bits
+	                                                          // are set
+
+	inline unsigned int qIndex1(unsigned long i)  { return i >> BLOCKBITS; }
+	inline unsigned int qIndex2(unsigned long i)  { return i & BLOCKMASK; }
+
+	// Maximum number of entries in a queue (the positions in the read queue are unsigned int's)
+	static const unsigned long MAXLENGTH = 1UL << 32;
+
+	static const unsigned int WORDBITS = 5;                 // 5 Bit = 0..31, bits in one int
+	static const unsigned int WORDMASK = ((1<<WORDBITS)-1); // Bit mask where the last 5 Bits
+	                                                        // are set
+
+	inline confno_t bsIndex1(confno_t i) { return i >> (WORDBITS + BLOCKBITS); }
+	inline unsigned int bsIndex2(confno_t i) { return (i >> WORDBITS) & BLOCKMASK; }
+	inline unsigned int bsBitPos(confno_t i) { return i & WORDMASK; }
+
+	// The configuration numbers are split into chunks of 2^CHUNKBITS configurations, which
+	// are assigned to the partitions round-robin. The chunks are small, so even the small
+	// state space of an easy level is spread evenly over all partitions. Within its
+	// partition, chunk c gets the local number c / nParts; the bit set of a partition is
+	// indexed by these local numbers, so it only covers the configurations it owns.
+	static const unsigned int CHUNKBITS = WORDBITS + 6;     // 2048 configurations
+
+	inline confno_t chunk(confno_t i) { return i >> CHUNKBITS; }
+	inline confno_t localConf(confno_t i)
+	{
+		return ((chunk(i) / nParts) << CHUNKBITS) | (i & ((1 << CHUNKBITS) - 1));
+	}
+
+	// Checks if the given configuration is already contained in the bit set of partition
+	// 'part'. If not, the configuration is entered in the bit set and appended to the write
+	// queue of 'part'. Must only be called by the thread owning 'part'.
+	bool lookup_and_add(unsigned int part, confno_t conf, unsigned int pred, unsigned int box);
+
+ public:
+	/**
+	 * Constructor: Create a queue/bit set for configuration numbers between
+	 * 0 and numConf-1, which is split into 'nParts' partitions.
+	 */
+	PartBFSQueue(confno_t numConf, unsigned int nParts);
+
+	/**
+	 * Destructor: deallocate memory.
+	 */
+	~PartBFSQueue();
+
+	/**
+	 * Return the partition owning the given configuration.
+	 */
+	inline unsigned int owner(confno_t conf)
+	{
+		return chunk(conf) % nParts;
+	}
+
+	/**
+	 * Enter the start configuration. Must be called before the first call of pushDepth().
+	 */
+	void init(confno_t conf);
+
+	/**
+	 * Increase the tree depth by one. The previous write queues become the read queues for the
+	 * new tree depth. The old read queues are stored in a temporary file to determine the
+	 * solution path at the end. Must be called by a single thread.
+	 */
+	void pushDepth();
+
+	/**
+	 * Send a successor configuration from partition 'from' to the partition owning it.
+	 * 'predIndex' is the index of the predecessor configuration in the read queue of 'from',
+	 * 'box' the number of the moved box. Must only be called by the thread owning 'from'.
+	 */
+	void send(unsigned int from, confno_t conf, unsigned int predIndex, unsigned int box);
+
+	/**
+	 * Receive all messages sent to partition 'part' and enter the configurations that have
+	 * not been visited before into its write queue. If one of these configurations satisfies
+	 * 'isGoal', 'true' is returned, and the configuration and the global index of its
+	 * predecessor are stored in '*goal' and '*goalPred'. Must only be called by the thread
+	 * owning 'part', and only when no thread is sending.
+	 */
+	bool receive(unsigned int part, bool (*isGoal)(confno_t),
+				 confno_t * goal, unsigned int * goalPred);
+
+	/**
+	 * Return the total length of the read queues.
+	 */
+	unsigned long length();
+
+	/**
+	 * Return the length of the read queue of partition 'part'.
+	 */
+	unsigned int length(unsigned int part);
+
+	/**
+	 * Return the i-th entry in the read queue of partition 'part' (configuration as return
+	 * value; moved box in *box).
+	 */
+	confno_t get(unsigned int part, unsigned int i, unsigned int * box);
+
+	/**
+	 * Return the solution path as an array of configurations. The parameter conf is the
+	 * solution configuration, predIndex the global index of the predecessor configuration.
+	 * In *path_length the length of the path is returned. The result is allocated dynamically
+	 * and should be deallocated using delete[].
+	 */
+	confno_t * getPath(confno_t conf, unsigned int predIndex, unsigned int * path_length);
+
+	/**
+	 * Returns information about RAM and hard disk usage.
+	 */
+	void statistics();
+};
@@ -0,0 +1,364 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+#include "confno.h"
+#include "playfield.h"
+#include "patterndb.h"
+
+using namespace std;
+
+
+unsigned int PatternDB::nPos;                      // Number of fields that may contain a box
+unsigned int PatternDB::nFields;                   // Total number of fields
+unsigned int PatternDB::maxK;                      // Maximum number of boxes in a pattern
+unsigned int PatternDB::words;                     // Number of words of a bit set of fields
+unsigned long * PatternDB::pairMask;               // Patterns with two boxes
+unsigned long * PatternDB::partnerMask;            // Fields in common larger patterns
+vector<unsigned int> * PatternDB::patterns;        // Patterns with more than two boxes
+unsigned long PatternDB::nPatterns;                // Total number of patterns
+
+// Binomial coefficients n over k for n <= 256, k <= MAXK (for ranking sets of fields)
+static unsigned long binom[257][PatternDB::MAXK+1];
+
+// Rank of the sorted set of 'k' fields in 'pos' in the combinatorial number system
+// (see Converter).
+static inline unsigned long rankOf(const unsigned int pos[], unsigned int k)
+{
+	unsigned long r = 0;
+	for (unsigned int i=0; i<k; i++)
+		r += binom[pos[i]][i+1];
+	return r;
+}
+
+// Inverse of rankOf()
+static inline void unrank(unsigned long r, unsigned int pos[], unsigned int k)
+{
+	for (unsigned int i=k; i>0; i--) {
+		unsigned int p = i - 1;
+		while (binom[p+1][i] <= r)
+			p++;
+		pos[i-1] = p;
+		r -= binom[p][i];
+	}
+}
+
+// =========================================================
+
+/**
+ * Initialize the class for the level in the file 'levelFile' (see Playfield::init()).
+ * The patterns are read from the file '<levelFile>.patterns', if it exists, otherwise
+ * they are determined and stored in this file.
+ */
+void PatternDB::init(const char * levelFile)
+{
+	nPos = Playfield::nPos;
+	nFields = Playfield::nFields;
+	maxK = (Playfield::nBox < MAXK) ? Playfield::nBox : MAXK;
+	words = (nPos + 63) / 64;
+	pairMask = new unsigned long[nPos * words]();
+	partnerMask = new unsigned long[nPos * words]();
+	patterns = new vector<unsigned int>[nPos];
+	nPatterns = 0;
+
+	for (unsigned int n=0; n<=256; n++) {
+		binom[n][0] = 1;
+		for (unsigned int k=1; k<=MAXK; k++)
+			binom[n][k] = (n == 0) ? 0 : binom[n-1][k-1] + binom[n-1][k];
+	}
+
+	string fname = string(levelFile) + ".patterns";
+	if (!load(fname.c_str())) {
+		for (unsigned int k=2; k<=maxK; k++) {
+			if (!search(k))
+				break;
+		}
+		save(fname.c_str());
+	}
+	for (unsigned int p=0; p<nPos; p++)
+		sort(patterns[p].begin(), patterns[p].end());
+	cout << "Deadlock patterns: " << nPatterns << "\n";
+}
+
+/**
+ * Are the fields 'p' and 'q' in a common window?
+ */
+bool PatternDB::isNear(unsigned int p, unsigned int q)
+{
+	int stride = Playfield::cellShift[3];
+	int dx = (int)(Playfield::cellNo[p] % stride) - (int)(Playfield::cellNo[q] % stride);
+	int dy = (int)(Playfield::cellNo[p] / stride) - (int)(Playfield::cellNo[q] / stride);
+	return (abs(dx) < (int)WINDOW) && (abs(dy) < (int)WINDOW);
+}
+
+/**
+ * Add the pattern consisting of the 'k' fields in 'pos' (sorted).
+ */
+void PatternDB::add(const unsigned int pos[], unsigned int k)
+{
+	nPatterns++;
+	if (k == 2) {
+		pairMask[pos[0]*words + pos[1]/64] |= 1UL << (pos[1] % 64);
+		pairMask[pos[1]*words + pos[0]/64] |= 1UL << (pos[0] % 64);
+		return;
+	}
+	// For each field of the pattern, store the other fields
+	for (unsigned int i=0; i<k; i++) {
+		unsigned int others[MAXK];
+		unsigned int n = 0;
+		for (unsigned int j=0; j<k; j++) {
+			if (j != i) {
+				others[n++] = pos[j];
+				partnerMask[pos[i]*words + pos[j]/64] |= 1UL << (pos[j] % 64);
+			}
+		}
+		patterns[pos[i]].push_back(encode(others, n));
+	}
+}
+
+/**
+ * Does the set of 'k' fields in 'pos' (sorted) contain a pattern with less than 'k' fields?
+ */
+bool PatternDB::containsPattern(const unsigned int pos[], unsigned int k)
+{
+	// It suffices to check the subsets with k-1 fields (which have been checked for smaller
+	// patterns themselves)
+	for (unsigned int i=0; i<k; i++) {
+		unsigned int sub[MAXK];
+		unsigned int n = 0;
+		for (unsigned int j=0; j<k; j++) {
+			if (j != i)
+				sub[n++] = pos[j];
+		}
+		if (n == 2) {
+			if (pairMask[sub[0]*words + sub[1]/64] & (1UL << (sub[1] % 64)))
+				return true;
+		}
+		else if (n > 2) {
+			unsigned int code = encode(&sub[1], n-1);
+			vector<unsigned int> & v = patterns[sub[0]];
+			if (find(v.begin(), v.end(), code) != v.end())
+				return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Determine the patterns with 'k' boxes by a backward search. Returns false if the
+ * search would need too much memory.
+ */
+bool PatternDB::search(unsigned int k)
+{
+	unsigned long nSets = binom[nPos][k];
+	if (nSets * nFields > MAXSTATES)
+		return false;
+
+	// The state (set of box positions with rank r, player on field f) has number r*nFields+f.
+	// 'found' is the bit set of the states found by the backward search.
+	unsigned long nStates = nSets * nFields;
+	vector<bool> found(nStates, false);
+	vector<unsigned int> queue;
+	unsigned int pos[MAXK];
+
+	// Start with all sets of k targets, and all player positions
+	for (unsigned long r=0; r<binom[Playfield::nBox][k]; r++) {
+		unsigned int goals[MAXK];
+		unrank(r, goals, k);
+		for (unsigned int i=0; i<k; i++)
+			pos[i] = Playfield::goalPos[goals[i]];
+		sort(pos, pos+k);
+		unsigned long base = rankOf(pos, k) * nFields;
+		for (unsigned int f=0; f<nFields; f++) {
+			if (!found[base + f] && (find(pos, pos+k, f) == pos+k)) {
+				found[base + f] = true;
+				queue.push_back(base + f);
+			}
+		}
+	}
+
+	// Backward search: the player moves to a neighboring field, possibly pulling a box
+	// from the opposite side. The box must not be pulled onto a dead-end.
+	for (unsigned long i=0; i<queue.size(); i++) {
+		unsigned long r = queue[i] / nFields;
+		unsigned int f = queue[i] % nFields;
+		unrank(r, pos, k);
+		for (unsigned int dir=0; dir<4; dir++) {
+			unsigned int to = Playfield::neighbor[dir][f];
+			if (!Playfield::isValid(to) || (find(pos, pos+k, to) != pos+k))
+				continue;
+			// Move the player
+			unsigned long s = r * nFields + to;
+			if (!found[s]) {
+				found[s] = true;
+				queue.push_back(s);
+			}
+			// Pull the box behind the player (if any)
+			unsigned int from = Playfield::neighbor[dir^2][f];
+			unsigned int * box = find(pos, pos+k, from);
+			if (!Playfield::isValid(from) || (box == pos+k) || Playfield::isDead(f))
+				continue;
+			unsigned int newPos[MAXK];
+			memcpy(newPos, pos, k * sizeof(unsigned int));
+			newPos[box - pos] = f;
+			// Insertion sort of the k positions (std::sort on the fixed size array makes
+			// the compiler warn about accesses beyond MAXK)
+			for (unsigned int a=1; a<k; a++) {
+				unsigned int p = newPos[a];
+				unsigned int b = a;
+				for (; (b > 0) && (newPos[b-1] > p); b--)
+					newPos[b] = newPos[b-1];
+				newPos[b] = p;
+			}
+			s = rankOf(newPos, k) * nFields + to;
+			if (!found[s]) {
+				found[s] = true;
+				queue.push_back(s);
+			}
+		}
+	}
+
+	// All sets of box positions that are not found for any player position are patterns
+	for (unsigned long r=0; r<nSets; r++) {
+		unrank(r, pos, k);
+		bool near = true;
+		for (unsigned int i=0; (i<k) && (k>2) && near; i++) {
+			for (unsigned int j=i+1; j<k; j++)
+				near = near && isNear(pos[i], pos[j]);
+		}
+		if (!near || containsPattern(pos, k))
+			continue;
+		bool dead = true;
+		for (unsigned int f=0; (f<nFields) && dead; f++)
+			dead = !found[r*nFields + f];
+		if (dead)
+			add(pos, k);
+	}
+	return true;
+}
+
+/**
+ * Compute a hash value of the playing field, which identifies the level in the file.
+ */
+unsigned long PatternDB::levelHash()
+{
+	unsigned long h = nPos * 1000003UL + nFields;
+	for (unsigned int dir=0; dir<4; dir++) {
+		for (unsigned int f=0; f<nFields; f++)
+			h = h * 31 + Playfield::neighbor[dir][f];
+	}
+	for (unsigned int i=0; i<Playfield::nBox; i++)
+		h = h * 31 + Playfield::goalPos[i];
+	return h * 31 + MAXK * 100 + WINDOW;
+}
+
+/**
+ * Read the patterns from the file 'fname'. Returns false if the file does not exist
+ * or belongs to another level.
+ */
+bool PatternDB::load(const char * fname)
+{
+	ifstream in(fname);
+	unsigned long hash, n;
+	if (!in || !(in >> hash >> n) || (hash != levelHash()))
+		return false;
+	for (unsigned long i=0; i<n; i++) {
+		unsigned int k;
+		unsigned int pos[MAXK];
+		if (!(in >> k) || (k < 2) || (k > MAXK))
+			return false;
+		for (unsigned int j=0; j<k; j++) {
+			if (!(in >> pos[j]) || (pos[j] >= nPos))
+				return false;
+		}
+		add(pos, k);
+	}
+	return true;
+}
+
+/**
+ * Write the patterns into the file 'fname'.
+ */
+void PatternDB::save(const char * fname)
+{
+	ofstream out(fname);
+	if (!out) {
+		cerr << "Cannot write patterns to '" << fname << "'\n";
+		return;
+	}
+	out << levelHash() << " " << nPatterns << "\n";
+	for (unsigned int p=0; p<nPos; p++) {
+		for (unsigned int q=p+1; q<nPos; q++) {
+			if (pairMask[p*words + q/64] & (1UL << (q % 64)))
+				out << "2 " << p << " " << q << "\n";
+		}
+		// Each pattern with more boxes is written once, for its smallest field
+		for (unsigned int i=0; i<patterns[p].size(); i++) {
+			unsigned int code = patterns[p][i];
+			unsigned int k = code >> (8 * ((code >> 24) ? 3 : 2));
+			unsigned int others[MAXK];
+			for (unsigned int j=0; j<k; j++)
+				others[k-1-j] = (code >> (8*j)) & 255;
+			if (others[0] < p)
+				continue;
+			out << (k+1) << " " << p;
+			for (unsigned int j=0; j<k; j++)
+				out << " " << others[j];
+			out << "\n";
+		}
+	}
+}
+
+/**
+ * Checks whether the boxes contain a pattern which includes the box on field 'newPos'.
+ * 'boxes' is the bit set of the box positions (see Config), 'boxPos' contains the
+ * positions of all 'nBox' boxes.
+ */
+bool PatternDB::matches(unsigned int newPos, const unsigned long boxes[],
+						const unsigned int boxPos[], unsigned int nBox)
+{
+	// Patterns with two boxes: a single test of the bit sets
+	const unsigned long * mask = &pairMask[newPos * words];
+	for (unsigned int w=0; w<words; w++) {
+		if (mask[w] & boxes[w])
+			return true;
+	}
+	vector<unsigned int> & v = patterns[newPos];
+	if (v.empty())
+		return false;
+
+	// Patterns with more boxes: check all subsets of the other boxes which occur in a
+	// pattern together with the moved box
+	mask = &partnerMask[newPos * words];
+	unsigned int near[nBox];
+	unsigned int n = 0;
+	for (unsigned int i=0; i<nBox; i++) {
+		if (mask[boxPos[i]/64] & (1UL << (boxPos[i] % 64)))
+			near[n++] = boxPos[i];
+	}
+	// All fields of a pattern must be partners of each other
+	unsigned int sub[MAXK];
+	for (unsigned int i=0; i<n; i++) {
+		sub[0] = near[i];
+		for (unsigned int j=i+1; j<n; j++) {
+			if (!isPartner(sub[0], near[j]))
+				continue;
+			sub[1] = near[j];
+			if (binary_search(v.begin(), v.end(), encode(sub, 2)))
+				return true;
+			for (unsigned int l=j+1; (l<n) && (maxK > 3); l++) {
+				if (!isPartner(sub[0], near[l]) || !isPartner(sub[1], near[l]))
+					continue;
+				sub[2] = near[l];
+				if (binary_search(v.begin(), v.end(), encode(sub, 3)))
+					return true;
+			}
+		}
+	}
+	return false;
+}
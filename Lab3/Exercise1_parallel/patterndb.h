@@ -0,0 +1,106 @@
+using namespace std;
+
+/**
+ * This class (with only static attributes and methods) contains a database of deadlock
+ * patterns for the current level: small sets of 2 ... MAXK box positions such that the boxes
+ * can not all be pushed onto targets, even if there are no other boxes on the playing field
+ * (and for any position of the player). Since additional boxes can only be obstacles, each
+ * configuration containing such a pattern is a deadlock.
+ * For each number of boxes k, the patterns are found by a backward search from all
+ * configurations with k boxes on targets, which pulls the boxes (like Config::getPrevConfig())
+ * and moves the player. All sets of k box positions not found by this search are patterns,
+ * unless they contain a smaller pattern. Patterns with more than two boxes are only stored if
+ * the boxes lie in a window of WINDOW x WINDOW fields, so only few patterns must be checked
+ * after a push.
+ * Since the search takes some time for larger levels, the patterns are stored in a file next
+ * to the level file and reused on the next run.
+ */
+class PatternDB
+{
+ private:
+	static unsigned int nPos;           // Number of fields that may contain a box
+	static unsigned int nFields;        // Total number of fields
+	static unsigned int maxK;           // Maximum number of boxes in a pattern for this level
+	static unsigned int words;          // Number of 64-bit words of a bit set of fields
+
+	// pairMask[p*words ... (p+1)*words-1] is the bit set of the fields 'q' such that boxes on
+	// 'p' and 'q' are a pattern.
+	static unsigned long * pairMask;
+
+	// partnerMask[p*words ... (p+1)*words-1] is the bit set of the fields that occur together
+	// with field 'p' in a pattern with more than two boxes.
+	static unsigned long * partnerMask;
+
+	// patterns[p] contains the patterns with more than two boxes including field 'p': the
+	// other fields of the pattern are encoded by encode(), the vector is sorted.
+	static vector<unsigned int> * patterns;
+
+	// Total number of patterns
+	static unsigned long nPatterns;
+
+	// Maximum number of states of a backward search (one bit each, and up to four bytes in
+	// the queue)
+	static const unsigned long MAXSTATES = 1UL << 25;
+
+	// Encode the 'k' field numbers in 'pos' (sorted) into a single integer.
+	static inline unsigned int encode(const unsigned int pos[], unsigned int k)
+	{
+		unsigned int code = k;
+		for (unsigned int i=0; i<k; i++)
+			code = (code << 8) | pos[i];
+		return code;
+	}
+
+	// Do the fields 'p' and 'q' occur together in a pattern with more than two boxes?
+	static inline bool isPartner(unsigned int p, unsigned int q)
+	{
+		return (partnerMask[p*words + q/64] >> (q % 64)) & 1;
+	}
+
+	// Are the fields 'p' and 'q' in a common window?
+	static bool isNear(unsigned int p, unsigned int q);
+
+	// Add the pattern consisting of the 'k' fields in 'pos' (sorted).
+	static void add(const unsigned int pos[], unsigned int k);
+
+	// Does the set of 'k' fields in 'pos' (sorted) contain a pattern with less than 'k'
+	// fields?
+	static bool containsPattern(const unsigned int pos[], unsigned int k);
+
+	// Determine the patterns with 'k' boxes by a backward search. Returns false if the
+	// search would need too much memory.
+	static bool search(unsigned int k);
+
+	// Compute a hash value of the playing field, which identifies the level in the file.
+	static unsigned long levelHash();
+
+	// Read the patterns from the file 'fname'. Returns false if the file does not exist
+	// or belongs to another level.
+	static bool load(const char * fname);
+
+	// Write the patterns into the file 'fname'.
+	static void save(const char * fname);
+
+ public:
+	/**
+	 * Maximum number of boxes in a pattern, and the size of the window for patterns with
+	 * more than two boxes.
+	 */
+	static const unsigned int MAXK = 4;
+	static const unsigned int WINDOW = 4;
+
+	/**
+	 * Initialize the class for the level in the file 'levelFile' (see Playfield::init()).
+	 * The patterns are read from the file '<levelFile>.patterns', if it exists, otherwise
+	 * they are determined and stored in this file.
+	 */
+	static void init(const char * levelFile);
+
+	/**
+	 * Checks whether the boxes contain a pattern which includes the box on field 'newPos'.
+	 * 'boxes' is the bit set of the box positions (see Config), 'boxPos' contains the
+	 * positions of all 'nBox' boxes.
+	 */
+	static bool matches(unsigned int newPos, const unsigned long boxes[],
+						const unsigned int boxPos[], unsigned int nBox);
+};
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <fstream>
 
+#include "confno.h"
 #include "config.h"
 
 // Ausgabe in Farbe. Fr normale Ausgabe bitte auskommentieren.
@@ -98,6 +99,47 @@ unsigned int Playfield::nPos;
  */
 unsigned int Playfield::nFields;
 
+/**
+ * Cell number of each field in bitboards.
+ */
+unsigned int * Playfield::cellNo;
+
+/**
+ * Offset between the cell number of a field and the cell number of its left, upper,
+ * right, and lower neighbor.
+ */
+int Playfield::cellShift[4];
+
+/**
+ * Number of 64-bit words of the bitboards needed for the level.
+ */
+unsigned int Playfield::boardWords;
+
+/**
+ * Bitboard containing all fields (i.e., all cells that are not walls).
+ */
+MaxBitBoard Playfield::validBoard;
+
+/**
+ * Bitboard containing the targets (fields 0 ... nBox-1).
+ */
+MaxBitBoard Playfield::goalBoard;
+
+/**
+ * Bitboard containing the dead-end fields (fields nPos ... nFields-1).
+ */
+MaxBitBoard Playfield::deadBoard;
+
+/**
+ * lowerBoard[f] is the bitboard containing the fields with numbers 0 ... f-1.
+ */
+MaxBitBoard * Playfield::lowerBoard;
+
+/**
+ * Mark the dead-ends automatically?
+ */
+bool Playfield::autoDead = false;
+
    
 // ==================================================================
 
@@ -132,6 +174,58 @@ void Playfield::init(const char * fname)
 	init(playfield, n-1);
 }
 
+/**
+ * Mark all fields in the textual representation 'field' from which a single box can not be
+ * pushed onto any target as dead-ends, in addition to those marked in the level file. Thus,
+ * they are numbered like the marked dead-ends by init(), and the number of fields that may
+ * contain a box (nPos) and the number of configurations decrease.
+ * The fields are found by pulling a box away from all targets: the box can be pulled from
+ * field 'q' to its neighbor 'p', if the player can stand on the next field behind 'p'.
+ * Fields with a box are not marked, so the starting configuration stays valid. The player
+ * has already been removed from 'field' (see init()), so its starting field is marked like
+ * any other empty field; the player may stand on a dead-end.
+ */
+void Playfield::markDeadEnds(string field[])
+{
+	const int dx[4] = { -1, 0, 1, 0 };
+	const int dy[4] = { 0, -1, 0, 1 };
+	// live[y*nx + x]: can a box on field (x,y) be pushed onto a target?
+	bool * live = new bool[nx*ny];
+	unsigned int * queue = new unsigned int[nx*ny];
+	unsigned int len = 0;
+	for (unsigned int y=0; y<ny; y++) {
+		for (unsigned int x=0; x<nx; x++) {
+			char c = field[y][x];
+			live[y*nx + x] = (c == _goal) || (c == _goalBox);
+			if (live[y*nx + x])
+				queue[len++] = y*nx + x;
+		}
+	}
+	for (unsigned int i=0; i<len; i++) {
+		unsigned int qx = queue[i] % nx;
+		unsigned int qy = queue[i] / nx;
+		for (unsigned int dir=0; dir<4; dir++) {
+			unsigned int px = qx + dx[dir];     // New position of the box
+			unsigned int py = qy + dy[dir];
+			unsigned int mx = px + dx[dir];     // Position of the player
+			unsigned int my = py + dy[dir];
+			if ((my >= ny) || (mx >= nx) || (field[my][mx] == _wall)
+				|| (field[py][px] == _wall) || (field[py][px] == _dead) || live[py*nx + px])
+				continue;
+			live[py*nx + px] = true;
+			queue[len++] = py*nx + px;
+		}
+	}
+	for (unsigned int y=0; y<ny; y++) {
+		for (unsigned int x=0; x<nx; x++) {
+			if ((field[y][x] == _empty) && !live[y*nx + x])
+				field[y][x] = _dead;
+		}
+	}
+	delete[] live;
+	delete[] queue;
+}
+
 /**
  * the playing field from a textual representation. This consists of an
  * array for each row of the playing field, with a total of 'ny' rows.
@@ -149,7 +243,7 @@ void Playfield::init(string field[], unsigned int any)
 		for (unsigned int x=0; x<nx; x++) {
 			char c = field[y][x];
 			if ((c == _player) || (c == _goalPlayer) || (c == _deadPlayer)) {
-				if (playerX != -1) {
+				if (playerX != (unsigned int)-1) {
 					cerr << "Error: more than one player!";
 					exit(1);
 				}
@@ -161,11 +255,15 @@ void Playfield::init(string field[], unsigned int any)
 			}
 		}
 	}
-	if (playerX < 0) {
+	if (playerX == (unsigned int)-1) {
 		cerr << "Error: no player!\n";
 		exit(1);
 	}
 
+	// (1b) Determine further dead-ends, if requested
+	if (autoDead)
+		markDeadEnds(field);
+
 	// (2) Determine the number of fields, boxes and targets.
 	nFields = 0;
 	nPos = 0;
@@ -277,6 +375,48 @@ void Playfield::init(string field[], unsigned int any)
 			goalPos[i++] = p;
 		}
 	}
+
+	// (7) Assign the cells for the bitboards. We only use the bounding box of the fields
+	//     plus one unused column, which separates the rows.
+	unsigned int minX = nx, maxX = 0, minY = ny, maxY = 0;
+	for (i=0; i<nFields; i++) {
+		if (xPos[i] < minX) minX = xPos[i];
+		if (xPos[i] > maxX) maxX = xPos[i];
+		if (yPos[i] < minY) minY = yPos[i];
+		if (yPos[i] > maxY) maxY = yPos[i];
+	}
+	unsigned int stride = maxX - minX + 2;
+	unsigned int nCells = (maxY - minY + 1) * stride;
+	if (nCells > 64*MAXBOARDWORDS) {
+		cerr << "Error: playing field too large!\n";
+		exit(1);
+	}
+	boardWords = 1;
+	while (64*boardWords < nCells)
+		boardWords *= 2;
+	cellShift[0] = -1;
+	cellShift[1] = -(int)stride;
+	cellShift[2] = 1;
+	cellShift[3] = stride;
+
+	cellNo = new unsigned int[nFields];
+	lowerBoard = new MaxBitBoard[nFields+1];
+	validBoard.clear();
+	goalBoard.clear();
+	deadBoard.clear();
+	lowerBoard[0].clear();
+	for (i=0; i<nFields; i++) {
+		cellNo[i] = (yPos[i] - minY) * stride + (xPos[i] - minX);
+		validBoard.set(cellNo[i]);
+		if (isGoal(i))
+			goalBoard.set(cellNo[i]);
+		if (isDead(i))
+			deadBoard.set(cellNo[i]);
+		lowerBoard[i+1] = validBoard;
+	}
+
+	delete[] xPos;
+	delete[] yPos;
 }
 
 
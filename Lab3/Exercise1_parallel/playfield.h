@@ -1,3 +1,5 @@
+#include "bitboard.h"
+
 using namespace std;
 
 class Config;
@@ -14,6 +16,8 @@ class Config;
  *  - nPos ... nFields-1 : Fields that can only be occupied by the player.
  * The topologie ist stored in the array 'neighbors', which contains the left, upper, right,
  * and lower neighbor field for each field (if any, i.e., only if the field is not a wall).
+ * In addition, each field is mapped to a cell of the grid (see 'cellNo'), so sets of fields
+ * can be represented as bitboards (see class BitBoard).
  */
 class Playfield
 {
@@ -30,6 +34,10 @@ class Playfield
 	// array for each row of the playing field, with a total of 'ny' rows.
 	static void init(string field[], unsigned int ny);
 
+	// Mark the fields from which a box can not be pushed onto any target as dead-ends
+	// (see 'autoDead').
+	static void markDeadEnds(string field[]);
+
  public:
 	/**
 	 * Special value for the 'neighbor' array, if there is no neighboring field
@@ -72,6 +80,53 @@ class Playfield
 	 * Total number of fields.
 	 */
 	static unsigned int nFields;
+
+	/**
+	 * Cell number of each field in bitboards. The cells are numbered row by row (with one
+	 * unused cell between two rows), so the neighbor of a cell in direction 'dir' is the cell
+	 * with number cellNo + cellShift[dir].
+	 */
+	static unsigned int * cellNo;
+
+	/**
+	 * Offset between the cell number of a field and the cell number of its left, upper,
+	 * right, and lower neighbor.
+	 */
+	static int cellShift[4];
+
+	/**
+	 * Number of 64-bit words of the bitboards needed for the level (1, 2, 4, ..., or
+	 * MAXBOARDWORDS). The code
+	 * using bitboards is instantiated for each of these numbers (see class BitBoard).
+	 */
+	static unsigned int boardWords;
+
+	/**
+	 * Bitboard containing all fields (i.e., all cells that are not walls).
+	 */
+	static MaxBitBoard validBoard;
+
+	/**
+	 * Bitboard containing the targets (fields 0 ... nBox-1).
+	 */
+	static MaxBitBoard goalBoard;
+
+	/**
+	 * Bitboard containing the dead-end fields (fields nPos ... nFields-1).
+	 */
+	static MaxBitBoard deadBoard;
+
+	/**
+	 * lowerBoard[f] is the bitboard containing the fields with numbers 0 ... f-1
+	 * (f = 0 ... nFields).
+	 */
+	static MaxBitBoard * lowerBoard;
+
+	/**
+	 * If true, init() marks all fields from which a single box can not be pushed onto any
+	 * target as dead-ends, in addition to the dead-ends marked in the level file.
+	 */
+	static bool autoDead;
    
 	// ==================================================================
 
@@ -111,6 +166,62 @@ class Playfield
 		return pos >= nPos;
 	}
 
+	/**
+	 * Move each field of the set 'fields' to its neighbor in direction 'dir'. I.e., the result
+	 * contains the fields whose neighbor in direction dir^2 is in 'fields'. Fields without
+	 * such a neighbor are moved to a cell that is not a field.
+	 */
+	template <unsigned int W>
+	static inline BitBoard<W> shiftBoard(const BitBoard<W> & fields, unsigned int dir)
+	{
+		switch (dir) {
+		case 0:  return fields.shiftDown(1);
+		case 1:  return fields.shiftDown(cellShift[3]);
+		case 2:  return fields.shiftUp(1);
+		default: return fields.shiftUp(cellShift[3]);
+		}
+	}
+
+	/**
+	 * Return the set of fields in 'free' that can be reached from the fields in 'seed'
+	 * by moving through fields in 'free' (flood fill). The fill extends all fields of the set
+	 * at once: to the right along complete rows (see BitBoard::fillUp()), and into the other
+	 * directions by shifting the bitboard.
+	 */
+	template <unsigned int W>
+	static inline BitBoard<W> reachable(const BitBoard<W> & seed, const BitBoard<W> & free)
+	{
+		unsigned int stride = cellShift[3];
+		BitBoard<W> reach = seed & free;
+		while (true) {
+			reach = reach.fillUp(free);
+			BitBoard<W> grown = reach | ((reach.shiftDown(1) | reach.shiftDown(stride)
+									   | reach.shiftUp(stride)) & free);
+			if (grown == reach)
+				return reach;
+			reach = grown;
+		}
+	}
+
+	/**
+	 * Return the smallest field number in the (non-empty) set 'fields'.
+	 */
+	template <unsigned int W>
+	static inline unsigned int minField(const BitBoard<W> & fields)
+	{
+		// Binary search for the smallest f such that fields 0 ... f-1 intersect the set
+		unsigned int lo = 1;
+		unsigned int hi = nFields;
+		while (lo < hi) {
+			unsigned int m = (lo + hi) / 2;
+			if (fields.intersects(BitBoard<W>(lowerBoard[m])))
+				hi = m;
+			else
+				lo = m + 1;
+		}
+		return lo - 1;
+	}
+
 	/**
 	 * Print a configuration 'graphically'.
 	 */
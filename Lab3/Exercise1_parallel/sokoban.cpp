@@ -1,15 +1,32 @@
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <omp.h>
 
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
+#include "confno.h"
+#include "confighashmap.h"
+#include "transtable.h"
+#include "historyfile.h"
+#include "mappedarray.h"
 #include "converter.h"
 #include "config.h"
 #include "bfsqueue.h"
+#include "partbfsqueue.h"
 #include "dfsstack.h"
+#include "workdeque.h"
 #include "dfsdepthmap.h"
+#include "bfsfrontier.h"
+#include "externalqueue.h"
+#include "twobitmap.h"
+#include "lowerbound.h"
+#include "patterndb.h"
 
 using namespace std;
 
@@ -35,7 +52,7 @@ static double getTime()
  * the configuration 'conf', and which box must be moved in order to reach
  * this successor configuration.
  */
-static unsigned int checkSuccessor(Config *conf, unsigned long succNo)
+static unsigned int checkSuccessor(Config *conf, confno_t succNo)
 {
 	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
 	for (unsigned int box=0; box<nBoxes; box++) {
@@ -53,18 +70,18 @@ static unsigned int checkSuccessor(Config *conf, unsigned long succNo)
  * Print the path for a discovered solution, i.e., the sequence of configurations
  * that leads to the solution.
  */
-static void printPath(unsigned long path[], unsigned int length)
+static void printPath(confno_t path[], unsigned int length)
 {
 	if (length > 0) {
 		cerr << "\n";
 		cerr << "Found solution with " << (length-1) << " pushes\n";
 		cout << "\n";
-		unsigned int box = -1;
 		for (unsigned int i=0; i<length; i++) {
 			Config conf(path[i]);
 			cout << "Push " << i << ":\n";
 			conf.print();
-			box = (i < length-1) ? checkSuccessor(&conf, path[i+1]) : -1;
+			if (i < length-1)
+				checkSuccessor(&conf, path[i+1]);
 		}
 	}
 	else {
@@ -80,73 +97,211 @@ static void printPath(unsigned long path[], unsigned int length)
  * of depth 'depth-1', the possible successor configurations of depth 'depth' are determined
  * and entered into the queue for depth 'depth', if they have not already been examined
  * previously.
+ * If 'checkpointDir' is not NULL, a checkpoint is written into this directory after each
+ * tree depth (see BFSQueue::checkpoint()). If 'resume' is true, the search continues with
+ * the last checkpoint in this directory.
  */
-static void doBreadthFirstSearch(Config * conf)
+static void doBreadthFirstSearch(Config * conf, const char * checkpointDir, bool resume)
 {
 	// Create the queue for the configurations to be examined.
 	// At the beginning, the queue just contains the starting configuration.
-	BFSQueue * queue = new BFSQueue(Config::getNumConfigs());
-	queue->lookup_and_add(conf->getConfig(), -1, 0);
-	queue->pushDepth();
+	BFSQueue * queue;
+	if (checkpointDir != NULL)
+		queue = new BFSQueue(Config::getNumConfigs(), Config::numBoxes(), checkpointDir, resume);
+	else
+		queue = new BFSQueue(Config::getNumConfigs(), Config::numBoxes());
+	if (!resume) {
+		queue->lookup_and_add(conf->getConfig(), -1, 0);
+		queue->pushDepth();
+		if (checkpointDir != NULL)
+			queue->checkpoint();
+	}
 
+	const unsigned int CHUNK = 256;           // Configurations decoded at once
 	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
-	unsigned int depth = 1;                   // Tree depth
+	unsigned int depth = queue->getDepth();   // Tree depth
 	unsigned int length = queue->length();    // Number of configurations at depth 'depth-1'
-	unsigned int lastBox;                     // Box that was moved last
 
 	// Pass through all layers of the tree with increasing depth until there are no
-	// configurations with this depth any more.
+	// configurations with this depth any more. 'solved' is set by the (single) thread
+	// that finds a solution first; all other threads then stop examining configurations.
+	volatile bool solved = false;
+
+	while (length > 0) {
+		// Print the progress
+		cerr << "depth " << depth << ": " << length << "\n" << flush;
+		// Consider all configurations of depth 'depth-1'. The queue is thread-safe, so
+		// the threads do not have to synchronize when adding configurations. Since the
+		// number of successors differs strongly between configurations, we use a dynamic
+		// schedule for load balancing. Each iteration handles a chunk of configurations,
+		// whose box positions are determined at once.
+		#pragma omp parallel for schedule(dynamic)
+		for (unsigned int first=0; first<length; first+=CHUNK) {
+			if (solved)
+				continue;  // Solution already found
+			// Read the configurations from the queue
+			unsigned int n = (length - first < CHUNK) ? length - first : CHUNK;
+			confno_t confs[CHUNK];
+			unsigned int lastBoxes[CHUNK];
+			unsigned int positions[CHUNK * nBoxes];
+			for (unsigned int j=0; j<n; j++)
+				confs[j] = queue->get(first + j, &lastBoxes[j]);
+			Config::decode(n, confs, positions);
+
+			// A single configuration object is reused for the whole chunk
+			Config newConf;
+			for (unsigned int j=0; (j<n) && !solved; j++) {
+				unsigned int i = first + j;               // Index in the queue
+				unsigned int lastBox = lastBoxes[j];      // Box that was moved last
+				newConf.setConfig(confs[j], &positions[j*nBoxes]);
+				// Consider all boxes, starting with the box that was moved last
+				for (unsigned int b=0; (b<nBoxes) && !solved; b++) {
+					unsigned int box = (b + lastBox) % nBoxes;
+					// Consider all directions of movement
+					for (unsigned int dir=0; dir<4; dir++) {
+						unsigned int newBox;
+						// Determine the configuration that results from moving box
+						// 'box' in direction 'dir'.
+						confno_t c = newConf.getNextConfig(box, dir, &newBox);
+						// If the move is valid, check whether the resuling configuration has
+						// been examined before. If not, add it to the queue
+						if ((c != Config::NONE) && queue->lookup_and_add(c, i, newBox)) {
+							// If we found a solution: print it and terminate the search
+							if (Config::isSolutionConf(c)
+								&& __sync_bool_compare_and_swap(&solved, false, true)) {
+								unsigned int len;
+								confno_t * path = queue->getPath(c, i, &len);
+								printPath(path, len);
+								delete[] path;
+								queue->statistics();
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+		if (solved)
+			break;
+		// Advance the queue for the next tree depth
+		depth++;
+		queue->pushDepth();
+		if (checkpointDir != NULL)
+			queue->checkpoint();
+		// Number of configurations in the next tree depth
+		length = queue->length();
+	}
+
+	// If the loop exits normally, there is no solution
+	if (!solved) {
+		cout << "No solution found!\n";
+		queue->statistics();
+	}
+}
+
+/**
+ * Execute an owner-partitioned parallel breadth first search. Like doBreadthFirstSearch(), the
+ * search tree is examined layer by layer, but each thread owns a partition of the configuration
+ * numbers (see PartBFSQueue) and only expands the configurations of its own partition. The
+ * successor configurations are sent to their owners and entered in the owners' bit sets after
+ * a barrier. To limit the memory needed for the messages, each layer is processed in rounds of
+ * at most CHUNK configurations per thread.
+ */
+static void doPartitionedBreadthFirstSearch(Config * conf)
+{
+	const unsigned int CHUNK = 1 << 16;
+	unsigned int nParts = omp_get_max_threads();
 
-    bool stop_flag = false;
+	// Create the queue for the configurations to be examined.
+	// At the beginning, the queue just contains the starting configuration.
+	PartBFSQueue * queue = new PartBFSQueue(Config::getNumConfigs(), nParts);
+	queue->init(conf->getConfig());
+	queue->pushDepth();
 
+	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
+	unsigned int depth = 1;                   // Tree depth
+	unsigned long length = queue->length();   // Number of configurations at depth 'depth-1'
+	bool solved = false;
+	confno_t solution;                        // Solution configuration and global index
+	unsigned int solutionPred;                // of its predecessor
+
+	// Pass through all layers of the tree with increasing depth until there are no
+	// configurations with this depth any more.
 	while (length > 0) {
 		// Print the progress
 		cerr << "depth " << depth << ": " << length << "\n" << flush;
-		// Consider all configurations of depth 'depth-1'.
-        #pragma omp parallel for shared(nBoxes, length) private(lastBox)
-		for (unsigned int i=0; i<length; i++) {
-            if(stop_flag)
-                continue;  //solution found already
-			// Read the configuration from the queue
-			Config newConf(queue->get(i, &lastBox));
-			// Consider all boxes, starting with the box that was moved last
-			for (unsigned int b=0; b<nBoxes; b++) {
-				unsigned int box = (b + lastBox) % nBoxes;
-				// Consider all directions of movement
-				for (unsigned int dir=0; dir<4; dir++) {
-					unsigned int newBox;
-					// Determine the configuration that results from moving box
-					// 'box' in direction 'dir'.
-					unsigned long c = newConf.getNextConfig(box, dir, &newBox);
-					// If the move is valid, check whether the resuling configuration has
-					// been examined before. If not, add it to the queue
-                    bool test;
-					if ((c != Config::NONE)) {
-                        #pragma omp critical //implicit flush at entry to and exit from critical
-                        test = queue->lookup_and_add(c, i, newBox);
-                        if(test) {
-    						// If we found a solution: print it and terminate the search
-                            if (Config::isSolutionConf(c)) {
-                                stop_flag = true;
-    							unsigned int len;
-    							unsigned long * path = queue->getPath(c, i, &len);
-    							printPath(path, len);
-    							delete[] path;
-    							queue->statistics();
-    						}
-                        }
+
+		// Number of rounds needed for the largest partition
+		unsigned int nRounds = 0;
+		for (unsigned int p=0; p<nParts; p++) {
+			unsigned int n = (queue->length(p) + CHUNK - 1) / CHUNK;
+			if (n > nRounds)
+				nRounds = n;
+		}
+
+		// Usually each thread handles one partition. If OpenMP provides fewer threads than
+		// requested, a thread handles several partitions, so all of them are processed.
+		#pragma omp parallel num_threads(nParts)
+		{
+			unsigned int first = omp_get_thread_num();
+			unsigned int step = omp_get_num_threads();
+			unsigned int lastBox;
+			Config newConf;       // Reused for all configurations of this thread
+
+			for (unsigned int r=0; r<nRounds; r++) {
+				// (1) Expand the configurations of this round and send the successor
+				//     configurations to their owners.
+				for (unsigned int part=first; part<nParts; part+=step) {
+					unsigned int end = (r+1) * CHUNK;
+					if (end > queue->length(part))
+						end = queue->length(part);
+					for (unsigned int i=r*CHUNK; i<end; i++) {
+						newConf.setConfig(queue->get(part, i, &lastBox));
+						// Consider all boxes, starting with the box that was moved last
+						for (unsigned int b=0; b<nBoxes; b++) {
+							unsigned int box = (b + lastBox) % nBoxes;
+							for (unsigned int dir=0; dir<4; dir++) {
+								unsigned int newBox;
+								confno_t c = newConf.getNextConfig(box, dir, &newBox);
+								if (c != Config::NONE)
+									queue->send(part, c, i, newBox);
+							}
+						}
+					}
+				}
+				#pragma omp barrier
+
+				// (2) Receive the configurations sent to the partitions of this thread.
+				for (unsigned int part=first; part<nParts; part+=step) {
+					confno_t c;
+					unsigned int pred;
+					if (queue->receive(part, Config::isSolutionConf, &c, &pred)) {
+						#pragma omp critical
+						if (!solved) {
+							solved = true;
+							solution = c;
+							solutionPred = pred;
+						}
 					}
-                    #pragma omp flush(stop_flag)
-                    if(stop_flag)
-                        break;  //solution found already
 				}
-                // #pragma omp flush(stop_flag)
-                if(stop_flag)
-                    break;  //solution found already
+				#pragma omp barrier
+
+				// After the barrier, all threads see the same value of 'solved'
+				if (solved)
+					break;
 			}
 		}
-        if(stop_flag)
-            break;  //solution found already
+
+		// If we found a solution: print it and terminate the search
+		if (solved) {
+			unsigned int len;
+			confno_t * path = queue->getPath(solution, solutionPred, &len);
+			printPath(path, len);
+			delete[] path;
+			queue->statistics();
+			break;
+		}
+
 		// Advance the queue for the next tree depth
 		depth++;
 		queue->pushDepth();
@@ -155,11 +310,647 @@ static void doBreadthFirstSearch(Config * conf)
 	}
 
 	// If the loop exits normally, there is no solution
-    if(!stop_flag) {
-        cout << "No solution found!\n";
-        queue->statistics();
-    }
-    return;
+	if (!solved) {
+		cout << "No solution found!\n";
+		queue->statistics();
+	}
+	delete queue;
+}
+
+/**
+ * Execute an external-memory breadth first search. Like doBreadthFirstSearch(), the search
+ * tree is examined layer by layer, but the configurations are kept in files (see
+ * ExternalQueue), and duplicates are only removed when a tree depth is complete. Thus, the
+ * main memory needed is given by 'mBytes' (in MBytes) instead of the number of
+ * configurations.
+ */
+static void doExternalBreadthFirstSearch(Config * conf, unsigned long mBytes)
+{
+	ExternalQueue queue(mBytes);
+	queue.add(conf->getConfig());
+	queue.pushDepth();
+
+	const unsigned int CHUNK = 256;           // Configurations decoded at once
+	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
+	unsigned int depth = 1;                   // Tree depth
+	volatile bool solved = false;
+	confno_t solution = 0;
+
+	while (queue.length() > 0) {
+		// Print the progress
+		cerr << "depth " << depth << ": " << queue.length() << "\n" << flush;
+		// Each thread reads chunks of configurations from the current tree depth until
+		// the tree depth is exhausted
+		#pragma omp parallel
+		{
+			confno_t confs[CHUNK];
+			unsigned int positions[CHUNK * nBoxes];
+			Config newConf;
+			unsigned int n;
+			while (!solved && ((n = queue.read(confs, CHUNK)) > 0)) {
+				Config::decode(n, confs, positions);
+				for (unsigned int j=0; (j<n) && !solved; j++) {
+					newConf.setConfig(confs[j], &positions[j*nBoxes]);
+					for (unsigned int box=0; box<nBoxes; box++) {
+						for (unsigned int dir=0; dir<4; dir++) {
+							confno_t c = newConf.getNextConfig(box, dir, NULL);
+							if (c == Config::NONE)
+								continue;
+							if (Config::isSolutionConf(c)
+								&& __sync_bool_compare_and_swap(&solved, false, true))
+								solution = c;
+							queue.add(c);
+						}
+					}
+				}
+			}
+		}
+		if (solved)
+			break;
+		// Remove the duplicates and advance to the next tree depth
+		depth++;
+		queue.pushDepth();
+	}
+
+	if (solved) {
+		unsigned int len;
+		confno_t * path = queue.getPath(solution, &len);
+		printPath(path, len);
+		delete[] path;
+	}
+	else {
+		cout << "No solution found!\n";
+	}
+	queue.statistics();
+}
+
+/**
+ * Determine a neighbor of the configuration 'conf' with depth 'depth' in 'map'. If 'pred' is
+ * true, the neighbor is a predecessor (pulling a box back, see Config::getPrevConfig()),
+ * otherwise a successor.
+ */
+static confno_t getNeighborAtDepth(confno_t conf, DFSDepthMap * map, unsigned int depth,
+								   bool pred)
+{
+	Config cur(conf);
+	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
+	for (unsigned int box=0; box<nBoxes; box++) {
+		for (unsigned int dir=0; dir<4; dir++) {
+			confno_t c = pred ? cur.getPrevConfig(box, dir) : cur.getNextConfig(box, dir, NULL);
+			if ((c != Config::NONE) && (map->getDepth(c) == depth))
+				return c;
+		}
+	}
+	cerr << "FATAL ERROR: No neighbor found for the solution path!\n";
+	exit(1);
+}
+
+/**
+ * Execute a breadth first search that does not store any predecessor information. Like
+ * doBreadthFirstSearch(), the search tree is examined layer by layer, but only the
+ * configurations of the current and the next tree depth are kept (see BFSFrontier). In
+ * addition, the tree depth of each examined configuration is stored in a DFSDepthMap, which
+ * replaces the bit set. When a solution is found, the solution path is reconstructed backwards:
+ * for each configuration on the path, a predecessor is determined by pulling a box back (see
+ * Config::getPrevConfig()) such that the predecessor has been found at the next lower depth.
+ */
+static void doPredecessorFreeBreadthFirstSearch(Config * conf)
+{
+	// The depths are stored in one byte, 0 means 'not examined'. As in doBreadthFirstSearch(),
+	// the starting configuration has depth 1.
+	const unsigned int MAXDEPTH = 255;
+	DFSDepthMap map(Config::getNumConfigs(), MAXDEPTH);
+	BFSFrontier frontier(Config::getNumConfigs());
+	map.lookup_and_add(conf->getConfig(), 1);
+	frontier.add(conf->getConfig());
+	frontier.pushDepth();
+
+	const unsigned int CHUNK = 256;           // Configurations decoded at once
+	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
+	unsigned int depth = 1;                   // Tree depth
+	unsigned int length = frontier.length();  // Number of configurations at depth 'depth-1'
+
+	// 'solved' is set by the (single) thread that finds a solution first, this thread also
+	// stores the solution configuration in 'solution'.
+	volatile bool solved = false;
+	confno_t solution = 0;
+
+	while (length > 0) {
+		// Print the progress
+		cerr << "depth " << depth << ": " << length << "\n" << flush;
+		if (depth >= MAXDEPTH) {
+			cerr << "Error: the search needs more than " << (MAXDEPTH-1) << " pushes!\n";
+			exit(1);
+		}
+		// Consider all configurations of depth 'depth-1', see doBreadthFirstSearch()
+		#pragma omp parallel for schedule(dynamic)
+		for (unsigned int first=0; first<length; first+=CHUNK) {
+			if (solved)
+				continue;  // Solution already found
+			// Read the configurations from the frontier
+			unsigned int n = (length - first < CHUNK) ? length - first : CHUNK;
+			confno_t confs[CHUNK];
+			unsigned int positions[CHUNK * nBoxes];
+			for (unsigned int j=0; j<n; j++)
+				confs[j] = frontier.get(first + j);
+			Config::decode(n, confs, positions);
+
+			// A single configuration object is reused for the whole chunk
+			Config newConf;
+			for (unsigned int j=0; (j<n) && !solved; j++) {
+				newConf.setConfig(confs[j], &positions[j*nBoxes]);
+				for (unsigned int box=0; (box<nBoxes) && !solved; box++) {
+					for (unsigned int dir=0; dir<4; dir++) {
+						confno_t c = newConf.getNextConfig(box, dir, NULL);
+						// If the move is valid and the resulting configuration has not been
+						// examined before, add it to the frontier
+						if ((c != Config::NONE) && map.lookup_and_add(c, depth+1)) {
+							frontier.add(c);
+							if (Config::isSolutionConf(c)
+								&& __sync_bool_compare_and_swap(&solved, false, true)) {
+								solution = c;
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+		if (solved)
+			break;
+		// Advance the frontier for the next tree depth
+		depth++;
+		frontier.pushDepth();
+		// Number of configurations in the next tree depth
+		length = frontier.length();
+	}
+
+	if (solved) {
+		// Reconstruct the solution path backwards. The configuration path[k] has been
+		// found at depth k+1, so its predecessor on the path must have depth k.
+		unsigned int len = depth + 1;
+		confno_t * path = new confno_t[len];
+		path[len-1] = solution;
+		for (unsigned int k=len-1; k>0; k--)
+			path[k-1] = getNeighborAtDepth(path[k], &map, k, true);
+		printPath(path, len);
+		delete[] path;
+	}
+	else {
+		cout << "No solution found!\n";
+	}
+	cout << "Used " << frontier.memory() << " KBytes for arrays\n";
+	cout << "Used " << map.memory() << " KBytes for depth map\n";
+}
+
+/**
+ * Expand one tree depth of the bidirectional breadth first search (see
+ * doBidirectionalBreadthFirstSearch()). The configurations in the read queue of 'frontier' have
+ * depth 'depth' in 'map'; their successors (or predecessors, if 'backward' is true) which have
+ * not been examined before are entered into 'map' and the write queue of 'frontier'. If one of
+ * them has already been found by the search in the other direction (i.e., it is contained in
+ * 'other'), the searches meet; this configuration is stored in '*meet' and 'true' is returned.
+ */
+static bool expandFrontier(BFSFrontier * frontier, DFSDepthMap * map, DFSDepthMap * other,
+						   unsigned int depth, bool backward, confno_t * meet)
+{
+	const unsigned int CHUNK = 256;           // Configurations decoded at once
+	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
+	unsigned int length = frontier->length(); // Number of configurations to expand
+	volatile bool met = false;
+
+	#pragma omp parallel for schedule(dynamic)
+	for (unsigned int first=0; first<length; first+=CHUNK) {
+		if (met)
+			continue;  // The searches already met
+		unsigned int n = (length - first < CHUNK) ? length - first : CHUNK;
+		confno_t confs[CHUNK];
+		unsigned int positions[CHUNK * nBoxes];
+		for (unsigned int j=0; j<n; j++)
+			confs[j] = frontier->get(first + j);
+		Config::decode(n, confs, positions);
+
+		// A single configuration object is reused for the whole chunk
+		Config newConf;
+		for (unsigned int j=0; (j<n) && !met; j++) {
+			newConf.setConfig(confs[j], &positions[j*nBoxes]);
+			for (unsigned int box=0; (box<nBoxes) && !met; box++) {
+				for (unsigned int dir=0; dir<4; dir++) {
+					confno_t c = backward ? newConf.getPrevConfig(box, dir)
+										  : newConf.getNextConfig(box, dir, NULL);
+					if ((c != Config::NONE) && map->lookup_and_add(c, depth+1)) {
+						frontier->add(c);
+						if ((other->getDepth(c) != 0)
+							&& __sync_bool_compare_and_swap(&met, false, true)) {
+							*meet = c;
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+	frontier->pushDepth();
+	return met;
+}
+
+/**
+ * Execute a bidirectional breadth first search. A forward search starts at the starting
+ * configuration 'conf', and a backward search, which pulls the boxes instead of pushing them
+ * (see Config::getPrevConfig()), starts at all solution configurations. In each step, the
+ * search with the smaller frontier is expanded by one tree depth, until both searches find a
+ * common configuration. Since complete tree depths are expanded, the first common configuration
+ * lies on a shortest solution path.
+ * Both searches store the depths of the configurations found in a DFSDepthMap, so the
+ * solution path is determined like in doPredecessorFreeBreadthFirstSearch().
+ */
+static void doBidirectionalBreadthFirstSearch(Config * conf)
+{
+	// The depths are stored in one byte, 0 means 'not examined'. The starting configuration
+	// and the solution configurations have depth 1.
+	const unsigned int MAXDEPTH = 255;
+	DFSDepthMap fMap(Config::getNumConfigs(), MAXDEPTH);
+	DFSDepthMap bMap(Config::getNumConfigs(), MAXDEPTH);
+	BFSFrontier fFrontier(Config::getNumConfigs());
+	BFSFrontier bFrontier(Config::getNumConfigs());
+
+	fMap.lookup_and_add(conf->getConfig(), 1);
+	fFrontier.add(conf->getConfig());
+	fFrontier.pushDepth();
+	confno_t goals[1 + 3*Config::numBoxes()];
+	unsigned int nGoals = Config::getSolutionConfigs(goals);
+	for (unsigned int i=0; i<nGoals; i++) {
+		bMap.lookup_and_add(goals[i], 1);
+		bFrontier.add(goals[i]);
+	}
+	bFrontier.pushDepth();
+
+	unsigned int fDepth = 1;          // Depth of the configurations in the forward frontier
+	unsigned int bDepth = 1;          // Depth of the configurations in the backward frontier
+	unsigned long fCount = 1;         // Number of configurations found by the forward search
+	unsigned long bCount = nGoals;    // Number of configurations found by the backward search
+	bool met = false;
+	confno_t meet;
+
+	while ((fFrontier.length() > 0) && (bFrontier.length() > 0)) {
+		// Print the progress
+		cerr << "depth " << fDepth << "+" << bDepth << ": "
+			 << fFrontier.length() << "+" << bFrontier.length() << "\n" << flush;
+		if ((fDepth >= MAXDEPTH) || (bDepth >= MAXDEPTH)) {
+			cerr << "Error: the search needs more than " << (MAXDEPTH-1) << " pushes!\n";
+			exit(1);
+		}
+		// Expand the smaller frontier
+		if (fFrontier.length() <= bFrontier.length()) {
+			met = expandFrontier(&fFrontier, &fMap, &bMap, fDepth, false, &meet);
+			fDepth++;
+			fCount += fFrontier.length();
+		}
+		else {
+			met = expandFrontier(&bFrontier, &bMap, &fMap, bDepth, true, &meet);
+			bDepth++;
+			bCount += bFrontier.length();
+		}
+		if (met)
+			break;
+	}
+
+	if (met) {
+		// The meeting configuration has depth 'f' in the forward and 'b' in the backward
+		// search. The first part of the path is reconstructed backwards using the depths of
+		// the forward search, the second part forwards using those of the backward search.
+		unsigned int f = fMap.getDepth(meet);
+		unsigned int b = bMap.getDepth(meet);
+		unsigned int len = f + b - 1;
+		confno_t * path = new confno_t[len];
+		path[f-1] = meet;
+		for (unsigned int k=f-1; k>0; k--)
+			path[k-1] = getNeighborAtDepth(path[k], &fMap, k, true);
+		for (unsigned int k=f; k<len; k++)
+			path[k] = getNeighborAtDepth(path[k-1], &bMap, len-k, false);
+		printPath(path, len);
+		delete[] path;
+	}
+	else {
+		cout << "No solution found!\n";
+	}
+	cout << "Examined " << fCount << "+" << bCount << " configurations\n";
+	cout << "Used " << (fFrontier.memory() + bFrontier.memory()) << " KBytes for arrays\n";
+	cout << "Used " << (fMap.memory() + bMap.memory()) << " KBytes for depth maps\n";
+}
+
+// Distance of the tree depths at which the layered breadth first search saves a snapshot of
+// the two-bit map (see expandLayers())
+static const unsigned int SNAPSHOTINTERVAL = 4;
+
+/**
+ * Expand the tree depths of a layered breadth first search (see doTwoBitBreadthFirstSearch())
+ * from the starting configuration 'conf', until a solution is found, there are no
+ * configurations left, or the configurations of depth 'maxDepth' have been determined. If
+ * 'verbose' is true, the progress is printed. Returns the tree depth of the last configurations
+ * determined; if a solution has been found, its number is stored in '*solution'. At the end,
+ * the configurations of the returned depth are marked as 'next' in 'map', those of all lower
+ * depths are CLOSED.
+ * Before expanding each depth that is a multiple of SNAPSHOTINTERVAL, a snapshot of the map
+ * is appended to 'snapshots' (if there is none for this depth yet), and its position is
+ * stored in 'offsets'. The search starts with the last snapshot taken before 'maxDepth', or
+ * at 'conf' if there is none.
+ */
+static unsigned int expandLayers(Config * conf, TwoBitMap * map, HistoryFile * snapshots,
+								 vector<unsigned long> * offsets, unsigned int maxDepth,
+								 bool verbose, volatile bool * solved, confno_t * solution)
+{
+	unsigned int depth = 1;                   // Tree depth
+	unsigned long s = maxDepth / SNAPSHOTINTERVAL;
+	if (s > offsets->size())
+		s = offsets->size();
+	if (s > 0) {
+		map->restore(snapshots, (*offsets)[s-1]);
+		depth = s * SNAPSHOTINTERVAL;
+	}
+	else
+		map->reset(conf->getConfig());
+
+	// Each iteration of the parallel loop scans the configurations in SCAN words of the array
+	const unsigned int SCAN = 8;
+	const unsigned int CHUNK = SCAN * TwoBitMap::WORDSIZE;
+	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
+	unsigned long nWords = map->words();      // Number of words to scan
+	unsigned long length = 1;                 // Number of configurations at depth 'depth-1'
+
+	*solved = false;
+	while (true) {
+		// Print the progress
+		if (verbose)
+			cerr << "depth " << depth << ": " << length << "\n" << flush;
+		// Save a snapshot for determining the solution path
+		if ((depth % SNAPSHOTINTERVAL == 0) && (depth / SNAPSHOTINTERVAL > offsets->size()))
+			offsets->push_back(map->save(snapshots));
+		// Scan the whole array for configurations of depth 'depth-1'. Since the number of
+		// successors differs strongly between configurations, we use a dynamic schedule.
+		length = 0;
+		#pragma omp parallel for schedule(dynamic, 64) reduction(+:length)
+		for (unsigned long first=0; first<nWords; first+=SCAN) {
+			if (*solved)
+				continue;  // Solution already found
+			unsigned long last = (nWords - first < SCAN) ? nWords : first + SCAN;
+			confno_t confs[CHUNK];
+			unsigned int n = 0;
+			for (unsigned long w=first; w<last; w++)
+				n += map->getCurrent(w, &confs[n]);
+			if (n == 0)
+				continue;
+			unsigned int positions[CHUNK * nBoxes];
+			Config::decode(n, confs, positions);
+
+			// A single configuration object is reused for the whole chunk
+			Config newConf;
+			for (unsigned int j=0; (j<n) && !*solved; j++) {
+				newConf.setConfig(confs[j], &positions[j*nBoxes]);
+				for (unsigned int box=0; (box<nBoxes) && !*solved; box++) {
+					for (unsigned int dir=0; dir<4; dir++) {
+						confno_t c = newConf.getNextConfig(box, dir, NULL);
+						if ((c != Config::NONE) && map->add(c)) {
+							length++;
+							if (Config::isSolutionConf(c)
+								&& __sync_bool_compare_and_swap(solved, false, true)) {
+								*solution = c;
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+		if (*solved || (length == 0) || (depth == maxDepth))
+			return depth;
+		// Advance to the next tree depth
+		depth++;
+		map->pushDepth();
+	}
+}
+
+/**
+ * Determine a predecessor of the configuration 'conf' that has been found in the layered
+ * breadth first search. If 'closed' is true, the predecessor must be CLOSED.
+ */
+static confno_t getPredecessor(confno_t conf, TwoBitMap * map, bool closed)
+{
+	Config cur(conf);
+	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
+	for (unsigned int box=0; box<nBoxes; box++) {
+		for (unsigned int dir=0; dir<4; dir++) {
+			confno_t p = cur.getPrevConfig(box, dir);
+			if (p == Config::NONE)
+				continue;
+			unsigned int state = map->get(p);
+			if (closed ? (state == TwoBitMap::CLOSED) : (state != TwoBitMap::UNSEEN))
+				return p;
+		}
+	}
+	cerr << "FATAL ERROR: No predecessor found for the solution path!\n";
+	exit(1);
+}
+
+/**
+ * Execute a layered breadth first search using just two bits per configuration (see
+ * TwoBitMap). Instead of a queue, each tree depth is determined by scanning the array with
+ * the states of all configurations, so the memory needed is fixed.
+ * Since the map does not contain the depths of the configurations, the solution path is
+ * determined by repeating the search: after a search up to depth k, the predecessor of
+ * the path's configuration at depth k+1 which has been found (pulling a box back, see
+ * Config::getPrevConfig()) must have depth k, and a CLOSED predecessor of this configuration
+ * must have depth k-1. Thus, each repetition determines two configurations of the path.
+ * The repetitions do not start at the root, but with the snapshots of the map saved by the
+ * first search every SNAPSHOTINTERVAL depths in a temporary file, so each of them expands at
+ * most SNAPSHOTINTERVAL depths.
+ */
+static void doTwoBitBreadthFirstSearch(Config * conf)
+{
+	TwoBitMap map(Config::getNumConfigs());
+	HistoryFile snapshots("sokoban-twobit.tmp");
+	vector<unsigned long> offsets;
+	volatile bool solved;
+	confno_t solution;
+	unsigned int len = expandLayers(conf, &map, &snapshots, &offsets, -1, true, &solved,
+									&solution) + 1;
+
+	if (solved) {
+		confno_t * path = new confno_t[len];
+		path[0] = conf->getConfig();
+		path[len-1] = solution;
+		unsigned int k = len - 2;
+		while (k > 0) {
+			expandLayers(conf, &map, &snapshots, &offsets, k, false, &solved, &solution);
+			path[k] = getPredecessor(path[k+1], &map, false);
+			if (k > 1)
+				path[k-1] = getPredecessor(path[k], &map, true);
+			k = (k > 1) ? k - 2 : 0;
+		}
+		printPath(path, len);
+		delete[] path;
+	}
+	else {
+		cout << "No solution found!\n";
+	}
+	cout << "Used " << map.memory() << " KBytes for two-bit map\n";
+	cout << "Used " << (snapshots.length() / 1024) << " KBytes for temp file (snapshots)\n";
+}
+
+/**
+ * Execute an A* search from the given starting configuration. The configurations are examined
+ * in the order of increasing estimated solution length f = g + h, where g is the number of
+ * pushes needed to reach the configuration and h the lower bound for the remaining pushes
+ * (see LowerBound). Since h is consistent, a configuration is expanded at most once, and the
+ * first solution configuration expanded has a shortest solution path.
+ * The open list consists of buckets open[f][g]. Among the configurations with the smallest f,
+ * those with the largest g are expanded first (they are closest to a solution), all
+ * configurations of a bucket in parallel. The depth map stores g+1 for each configuration
+ * found, so the solution path is determined like in doPredecessorFreeBreadthFirstSearch().
+ */
+static void doAStarSearch(Config * conf)
+{
+	LowerBound::init();
+	const unsigned int MAXDEPTH = 255;
+	const unsigned int CHUNK = 256;           // Configurations decoded at once
+	unsigned int nBoxes = Config::numBoxes(); // Number of boxes
+	DFSDepthMap map(Config::getNumConfigs(), MAXDEPTH);
+
+	// Buckets of the open list, open[f][g] contains configurations with g pushes and
+	// estimated solution length f
+	vector< vector< vector<confno_t> > > open;
+	confno_t start = conf->getConfig();
+	unsigned int positions[nBoxes];
+	Config::decode(1, &start, positions);
+	LowerBound::Assignment assignment;
+	unsigned int f = LowerBound::estimate(positions, &assignment);
+	unsigned long nOpen = 0;                  // Number of entries in the open list
+	if (f != LowerBound::INFINITE) {
+		open.resize(f+1);
+		open[f].resize(1);
+		open[f][0].push_back(start);
+		map.lookup_and_set(start, 1);
+		nOpen = 1;
+	}
+
+	volatile bool solved = false;
+	confno_t solution = 0;
+	unsigned long expanded = 0;               // Number of configurations expanded
+	unsigned long maxOpen = nOpen;            // Maximum number of entries in the open list
+	unsigned int printed = -1;                // Last f printed
+
+	while (!solved && (f < open.size())) {
+		// Find the bucket with the largest g for the current f
+		unsigned int g = open[f].size();
+		while ((g > 0) && open[f][g-1].empty())
+			g--;
+		if (g == 0) {
+			f++;
+			continue;
+		}
+		g--;
+		// Print the progress (once for each f)
+		if (f != printed) {
+			cerr << "f " << f << ": " << nOpen << "\n" << flush;
+			printed = f;
+		}
+		if (g+2 > MAXDEPTH) {
+			cerr << "Error: the search needs more than " << (MAXDEPTH-1) << " pushes!\n";
+			exit(1);
+		}
+		// Take the contents of the bucket and expand them in parallel
+		vector<confno_t> cur;
+		cur.swap(open[f][g]);
+		unsigned int length = cur.size();
+		nOpen -= length;
+
+		#pragma omp parallel
+		{
+			// Successors found by this thread (with g+1 pushes), by their estimated length
+			vector< vector<confno_t> > found;
+
+			#pragma omp for schedule(dynamic) reduction(+:expanded)
+			for (unsigned int first=0; first<length; first+=CHUNK) {
+				if (solved)
+					continue;  // Solution already found
+				unsigned int n = (length - first < CHUNK) ? length - first : CHUNK;
+				unsigned int pos[CHUNK * nBoxes];
+				Config::decode(n, &cur[first], pos);
+
+				// A single configuration object is reused for the whole chunk
+				Config newConf;
+				for (unsigned int j=0; (j<n) && !solved; j++) {
+					confno_t confNo = cur[first+j];
+					// Skip the entry if the configuration has been found with fewer pushes
+					if (map.getDepth(confNo) != g+1)
+						continue;
+					if (Config::isSolutionConf(confNo)) {
+						if (__sync_bool_compare_and_swap(&solved, false, true))
+							solution = confNo;
+						break;
+					}
+					expanded++;
+					unsigned int * boxPos = &pos[j*nBoxes];
+					newConf.setConfig(confNo, boxPos);
+					// The assignment of each successor is updated from this one
+					LowerBound::Assignment parent, child;
+					LowerBound::estimate(boxPos, &parent);
+					for (unsigned int box=0; box<nBoxes; box++) {
+						unsigned int oldPos = boxPos[box];
+						for (unsigned int dir=0; dir<4; dir++) {
+							confno_t c = newConf.getNextConfig(box, dir, NULL);
+							if (c == Config::NONE)
+								continue;
+							if (!map.lookup_and_set(c, g+2))
+								continue;
+							// Only the row of the moved box changes in the assignment problem
+							boxPos[box] = Playfield::neighbor[dir][oldPos];
+							unsigned int h = LowerBound::update(boxPos, box, parent, &child);
+							boxPos[box] = oldPos;
+							if (h == LowerBound::INFINITE)
+								continue;
+							if (found.size() <= g+1+h)
+								found.resize(g+2+h);
+							found[g+1+h].push_back(c);
+						}
+					}
+				}
+			}
+
+			// Merge the successors into the open list
+			#pragma omp critical
+			{
+				if (open.size() < found.size())
+					open.resize(found.size());
+				for (unsigned int i=f; i<found.size(); i++) {
+					if (found[i].empty())
+						continue;
+					if (open[i].size() < g+2)
+						open[i].resize(g+2);
+					open[i][g+1].insert(open[i][g+1].end(), found[i].begin(), found[i].end());
+					nOpen += found[i].size();
+				}
+			}
+		}
+		if (nOpen > maxOpen)
+			maxOpen = nOpen;
+	}
+
+	if (solved) {
+		unsigned int len = map.getDepth(solution);
+		confno_t * path = new confno_t[len];
+		path[len-1] = solution;
+		for (unsigned int k=len-1; k>0; k--)
+			path[k-1] = getNeighborAtDepth(path[k], &map, k, true);
+		printPath(path, len);
+		delete[] path;
+	}
+	else {
+		cout << "No solution found!\n";
+	}
+	cout << "Expanded " << expanded << " configurations\n";
+	cout << "Used " << (maxOpen * sizeof(confno_t) / 1024) << " KBytes for open list\n";
+	cout << "Used " << map.memory() << " KBytes for depth map\n";
 }
 
 /**
@@ -167,7 +958,7 @@ static void doBreadthFirstSearch(Config * conf)
  * - best solution path found so far
  * - length of this path (= depth limit for the search)
  */
-static unsigned long * path = NULL;
+static confno_t * path = NULL;
 static unsigned int path_len = 0;
 
 /**
@@ -185,7 +976,7 @@ static void recDepthFirstSearch(Config * conf, unsigned int lastBox,
 								DFSStack * stack, DFSDepthMap * map)
 {
     // Get the configuration number and push it on the stack.
-	unsigned long c = conf->getConfig();
+	confno_t c = conf->getConfig();
 	stack->push(c);
 	unsigned int depth = stack->length();
 
@@ -221,22 +1012,18 @@ static void recDepthFirstSearch(Config * conf, unsigned int lastBox,
 			// already been found at the same or a smaller depth. If not, store
 			// the new depth for this configuration.
 			if ((c != Config::NONE)) {
-                bool test;
-                #pragma omp critical
-                test = map->lookup_and_set(c, depth+1);
-                if(test) {
+                if (map->lookup_and_set(c, depth+1)) {
+                    // The task gets its own copy of the stack and creates the successor
+                    // configuration itself. The copy is allocated on the heap (like the
+                    // bitboards of the configuration), so deep searches and tasks that are
+                    // executed immediately do not overflow the thread's stack.
                     DFSStack * stackCopy = new DFSStack(*stack);
-                    Config * nextN = new Config(c);
-                    #pragma omp task
+                    #pragma omp task firstprivate(c, box, stackCopy)
     				{
-    					// Recursively continue the search on a copy of the configuration
-    					recDepthFirstSearch(nextN, box, stackCopy, map);
+    					// Recursively continue the search on the successor configuration
+    					Config next(c);
+    					recDepthFirstSearch(&next, box, stackCopy, map);
     					delete stackCopy;
-                        /* Erase data */
-                        delete nextN;
-                        stackCopy = NULL;
-                        nextN = NULL;
-
     				}
                 }
 			}
@@ -248,54 +1035,342 @@ static void recDepthFirstSearch(Config * conf, unsigned int lastBox,
 /**
  * Wrapper procedure for recursive depth first search. The search starts at the
  * starting configuration 'conf' and continues up to the maximum depth 'maxDepth'.
+ * If 'ttMBytes' is not 0, the depths are stored in a transposition table of this size
+ * instead of the two-level array (see TranspositionTable).
  */
-static void doDepthFirstSearch(Config * conf, unsigned int maxDepth)
+static void doDepthFirstSearch(Config * conf, unsigned int maxDepth, unsigned long ttMBytes)
 {
 	DFSStack stack(maxDepth);
-	DFSDepthMap map(Config::getNumConfigs(), maxDepth);
-	map.lookup_and_set(conf->getConfig(), 1);
+	DFSDepthMap * map;
+	if (ttMBytes != 0)
+		map = new DFSDepthMap(maxDepth, ttMBytes);
+	else
+		map = new DFSDepthMap(Config::getNumConfigs(), maxDepth);
+	map->lookup_and_set(conf->getConfig(), 1);
 	path_len = maxDepth;
 
     #pragma omp parallel
     {
         #pragma omp single nowait
         {
-            recDepthFirstSearch(conf, 0, &stack, &map);
+            recDepthFirstSearch(conf, 0, &stack, map);
         }
     }
-	map.statistics(path_len);
+	map->statistics(path_len);
+	delete map;
 
 	printPath(path, path_len);
 	delete[] path;
 }
 
+/**
+ * Shared state of the work-stealing depth first search
+ * - length of the best solution path found so far (= depth limit for the search)
+ * - number of work items that have been created, but not yet been processed completely
+ * - number of work items stolen from other threads
+ */
+static volatile unsigned int bound;
+static volatile unsigned long pending;
+static volatile unsigned long steals;
+
+/**
+ * Remember the solution path stack[0 ... depth-1], if it is not longer than the best
+ * solution found so far.
+ */
+static void recordSolution(const confno_t stack[], unsigned int depth)
+{
+	#pragma omp critical
+	if (depth <= bound) {
+		delete[] path;
+		path = new confno_t[depth];
+		for (unsigned int i=0; i<depth; i++)
+			path[i] = stack[i];
+		path_len = depth;
+		bound = depth;
+		cout << "Found solution: " << (depth-1) << " pushes\n";
+	}
+}
+
+/**
+ * Sequential part of the work-stealing depth first search: examine the subtree of the
+ * configuration confs[depth-1] (with configuration number stack[depth-1]) recursively.
+ * 'stack' holds the path from the initial configuration, and 'confs' one configuration
+ * per tree depth. Both are owned by the calling thread and are reused in place, so no
+ * configuration or stack has to be copied or allocated. If 'deque' is not NULL, the
+ * successor configurations are not examined, but added to 'deque' as work items.
+ */
+static void seqDepthFirstSearch(Config confs[], confno_t stack[], unsigned int depth,
+								unsigned int lastBox, DFSDepthMap * map, WorkDeque * deque)
+{
+	Config * conf = &confs[depth-1];
+	if (Config::isSolutionConf(stack[depth-1])) {
+		recordSolution(stack, depth);
+		return;
+	}
+	if (depth >= bound)
+		return;
+
+	unsigned int nBoxes = Config::numBoxes();
+	for (unsigned int b=0; b < nBoxes; b++) {
+		unsigned int box = (b + lastBox) % nBoxes;
+		for (unsigned int dir=0; dir<4; dir++) {
+			confno_t c = conf->getNextConfig(box, dir, NULL);
+			if ((c == Config::NONE) || !map->lookup_and_set(c, depth+1))
+				continue;
+			if (deque != NULL) {
+				WorkItem item;
+				for (unsigned int i=0; i<depth; i++)
+					item.path[i] = stack[i];
+				item.path[depth] = c;
+				item.depth = depth+1;
+				item.lastBox = box;
+				__sync_fetch_and_add(&pending, 1);
+				deque->push(item);
+			}
+			else {
+				stack[depth] = c;
+				confs[depth].setConfig(c);
+				seqDepthFirstSearch(confs, stack, depth+1, box, map, NULL);
+			}
+		}
+	}
+}
+
+/**
+ * Work-stealing depth first search. Like doDepthFirstSearch(), the search starts at the
+ * starting configuration 'conf' and continues up to the maximum depth 'maxDepth'; the depths
+ * are stored in a DFSDepthMap (with a transposition table of 'ttMBytes' MBytes, if it is not
+ * 0). Instead of creating a task for each configuration, each thread owns a WorkDeque:
+ * configurations with a depth below WorkItem::MAXDEPTH are split into work items for their
+ * successors, deeper subtrees are examined sequentially by seqDepthFirstSearch(). Idle
+ * threads steal the items closest to the root from the other threads. The length of the best
+ * solution found so far is shared by all threads and bounds the search.
+ */
+static void doWorkStealingDepthFirstSearch(Config * conf, unsigned int maxDepth,
+										   unsigned long ttMBytes)
+{
+	if (maxDepth > DFSStack::MAXDEPTH) {
+		cerr << "Error: maximum depth is " << DFSStack::MAXDEPTH-1 << " pushes!\n";
+		exit(1);
+	}
+	DFSDepthMap * map;
+	if (ttMBytes != 0)
+		map = new DFSDepthMap(maxDepth, ttMBytes);
+	else
+		map = new DFSDepthMap(Config::getNumConfigs(), maxDepth);
+	map->lookup_and_set(conf->getConfig(), 1);
+	bound = maxDepth;
+	steals = 0;
+
+	unsigned int nThreads = omp_get_max_threads();
+	WorkDeque * deques = new WorkDeque[nThreads];
+	WorkItem root;
+	root.path[0] = conf->getConfig();
+	root.depth = 1;
+	root.lastBox = 0;
+	pending = 1;
+	deques[0].push(root);
+
+	#pragma omp parallel
+	{
+		unsigned int t = omp_get_thread_num();
+		Config * confs = new Config[maxDepth];
+		confno_t * stack = new confno_t[maxDepth];
+		WorkItem item;
+		while (pending > 0) {
+			// Take an item from the own deque, or steal one from another thread
+			bool found = deques[t].pop(&item);
+			for (unsigned int i=1; (i<nThreads) && !found; i++) {
+				found = deques[(t+i) % nThreads].steal(&item);
+				if (found)
+					__sync_fetch_and_add(&steals, 1);
+			}
+			if (!found) {
+				// Nothing to steal: leave the CPU to the threads that still have work
+				sched_yield();
+				continue;
+			}
+
+			for (unsigned int i=0; i<item.depth; i++)
+				stack[i] = item.path[i];
+			confs[item.depth-1].setConfig(stack[item.depth-1]);
+			seqDepthFirstSearch(confs, stack, item.depth, item.lastBox, map,
+								(item.depth < WorkItem::MAXDEPTH) ? &deques[t] : NULL);
+			__sync_fetch_and_sub(&pending, 1);
+		}
+		delete[] confs;
+		delete[] stack;
+	}
+	cout << "Stolen work items: " << steals << "\n";
+	map->statistics(bound);
+	delete map;
+	delete[] deques;
+
+	printPath(path, (path != NULL) ? path_len : 0);
+	delete[] path;
+	path = NULL;
+}
+
 /**
  * Main program. Invocation:
- *    sokoban <level-file> [<max-depth>]
+ *    sokoban [<options>] <level-file> [<max-depth>]
  * If 'max-depth' is give, a depth first search up to a maximum depth of 'max-depth'
  * is performed, otherwise a breadth first search.
+ * Options:
+ *    --partitioned  Use the owner-partitioned breadth first search
+ *                   (see doPartitionedBreadthFirstSearch()).
+ *    --nopred       Use the breadth first search without predecessor information
+ *                   (see doPredecessorFreeBreadthFirstSearch()).
+ *    --twobit       Use the layered breadth first search with two bits per configuration
+ *                   (see doTwoBitBreadthFirstSearch()).
+ *    --bidir        Use the bidirectional breadth first search
+ *                   (see doBidirectionalBreadthFirstSearch()).
+ *    --astar        Use the A* search with a lower bound for the remaining pushes
+ *                   (see doAStarSearch()).
+ *    --dead         Determine the dead-end fields automatically (see Playfield::init()).
+ *    --deadlocks    Use additional deadlock detectors (see Config::detectDeadlocks).
+ *    --patterns     Use the deadlock pattern database of the level (see PatternDB).
+ *    --steal        Use the work-stealing depth first search
+ *                   (see doWorkStealingDepthFirstSearch()).
+ *    --external <MBytes>
+ *                   Use the external-memory breadth first search with the given main
+ *                   memory (see doExternalBreadthFirstSearch()).
+ *    --checkpoint <dir>
+ *                   Write a checkpoint into the directory after each tree depth of the
+ *                   breadth first search (see BFSQueue::checkpoint()).
+ *    --resume       Continue the breadth first search with the last checkpoint.
+ *    --compress     Compress the swap file of the breadth first search
+ *                   (see BFSQueue::compressHistory).
+ *    --hugepages    Use transparent huge pages for the bit set and the depth map
+ *                   (see MappedArray::hugePages).
+ *    --tt <MBytes>  Use a transposition table with the given size for the depth first
+ *                   search (see TranspositionTable).
  */
 int main(int argc, char **argv)
 {
-	if ((argc < 2) || (argc > 3)) {
-		cerr << "Usage: sokoban <level-file> [<max-depth>]\n";
+	bool partitioned = false;
+	bool nopred = false;
+	bool twobit = false;
+	bool bidir = false;
+	bool astar = false;
+	bool steal = false;
+	unsigned long ttMBytes = 0;
+	unsigned long extMBytes = 0;
+	const char * checkpointDir = NULL;
+	bool resume = false;
+
+	// Parse the options
+	int arg = 1;
+	for (; (arg < argc) && (strncmp(argv[arg], "--", 2) == 0); arg++) {
+		if (strcmp(argv[arg], "--partitioned") == 0) {
+			partitioned = true;
+		}
+		else if (strcmp(argv[arg], "--nopred") == 0) {
+			nopred = true;
+		}
+		else if (strcmp(argv[arg], "--twobit") == 0) {
+			twobit = true;
+		}
+		else if (strcmp(argv[arg], "--bidir") == 0) {
+			bidir = true;
+		}
+		else if (strcmp(argv[arg], "--astar") == 0) {
+			astar = true;
+		}
+		else if (strcmp(argv[arg], "--dead") == 0) {
+			Playfield::autoDead = true;
+		}
+		else if (strcmp(argv[arg], "--deadlocks") == 0) {
+			Config::detectDeadlocks = true;
+		}
+		else if (strcmp(argv[arg], "--patterns") == 0) {
+			Config::usePatterns = true;
+		}
+		else if (strcmp(argv[arg], "--steal") == 0) {
+			steal = true;
+		}
+		else if ((strcmp(argv[arg], "--external") == 0) && (arg+1 < argc)) {
+			extMBytes = atol(argv[++arg]);
+			if (extMBytes == 0) {
+				cerr << "Error: invalid memory size for the external search\n";
+				exit(1);
+			}
+		}
+		else if ((strcmp(argv[arg], "--checkpoint") == 0) && (arg+1 < argc)) {
+			checkpointDir = argv[++arg];
+		}
+		else if (strcmp(argv[arg], "--resume") == 0) {
+			resume = true;
+		}
+		else if (strcmp(argv[arg], "--compress") == 0) {
+			BFSQueue::compressHistory = true;
+		}
+		else if (strcmp(argv[arg], "--hugepages") == 0) {
+			MappedArray::hugePages = true;
+		}
+		else if ((strcmp(argv[arg], "--tt") == 0) && (arg+1 < argc)) {
+			ttMBytes = atol(argv[++arg]);
+			if (ttMBytes == 0) {
+				cerr << "Error: invalid size of the transposition table\n";
+				exit(1);
+			}
+		}
+		else {
+			cerr << "Unknown option '" << argv[arg] << "'\n";
+			exit(1);
+		}
+	}
+
+	if ((argc - arg < 1) || (argc - arg > 2) || (resume && (checkpointDir == NULL))) {
+		cerr << "Usage: sokoban [--partitioned] [--nopred] [--twobit] [--bidir] [--astar] [--dead] [--deadlocks] [--patterns] [--steal] [--external <MBytes>] [--checkpoint <dir> [--resume]] [--compress] [--hugepages] [--tt <MBytes>] <level-file> [<max-depth>]\n";
 		exit(1);
 	}
 
 	// Initialize the configuration with the starting configuration (level) from the file
-	Config * conf = Config::init(argv[1]);
+	Config * conf = Config::init(argv[arg]);
+	if (Config::usePatterns)
+		PatternDB::init(argv[arg]);
 
 	double ta = getTime();
-	if (argc > 2) {
+	if (argc - arg > 1) {
 		// depth first search
-		unsigned int maxDepth = atoi(argv[2]);
-		doDepthFirstSearch(conf, maxDepth+1);
+		unsigned int maxDepth = atoi(argv[arg+1]);
+		if (steal)
+			doWorkStealingDepthFirstSearch(conf, maxDepth+1, ttMBytes);
+		else
+			doDepthFirstSearch(conf, maxDepth+1, ttMBytes);
+	}
+	else if (partitioned) {
+		// owner-partitioned breadth first search
+		doPartitionedBreadthFirstSearch(conf);
+	}
+	else if (nopred) {
+		// breadth first search without predecessor information
+		doPredecessorFreeBreadthFirstSearch(conf);
+	}
+	else if (twobit) {
+		// breadth first search with two bits per configuration
+		doTwoBitBreadthFirstSearch(conf);
+	}
+	else if (bidir) {
+		// bidirectional breadth first search
+		doBidirectionalBreadthFirstSearch(conf);
+	}
+	else if (astar) {
+		// A* search
+		doAStarSearch(conf);
+	}
+	else if (extMBytes != 0) {
+		// external-memory breadth first search
+		doExternalBreadthFirstSearch(conf, extMBytes);
 	}
 	else {
 		// breadth first search
-		doBreadthFirstSearch(conf);
+		doBreadthFirstSearch(conf, checkpointDir, resume);
 	}
 	double te = getTime();
+	if (Config::detectDeadlocks || Config::usePatterns)
+		Config::printDeadlockStatistics();
 
 	// Print the run time
 	cout << "\n";
@@ -0,0 +1,138 @@
+#include <omp.h>
+
+#include <iostream>
+
+#include "confno.h"
+#include "transtable.h"
+
+using namespace std;
+
+
+/**
+ * Constructor: Creates an empty table using (at most) 'mBytes' MBytes.
+ */
+TranspositionTable::TranspositionTable(unsigned long mBytes)
+{
+	// Largest power of two number of buckets fitting into the memory (but at least 256)
+	unsigned long nBuckets = (mBytes << 20) / (BUCKETSIZE * sizeof(unsigned long));
+	indexBits = 8;
+	while ((2UL << indexBits) <= nBuckets)
+		indexBits++;
+	table = new volatile unsigned long[BUCKETSIZE << indexBits]();
+
+	nThreads = omp_get_max_threads();
+	counters = new unsigned long[nThreads * BUCKETSIZE]();
+}
+
+/**
+ * Destructor: deallocate memory.
+ */
+TranspositionTable::~TranspositionTable()
+{
+	delete[] table;
+	delete[] counters;
+}
+
+/**
+ * Return the row of counters of the calling thread.
+ */
+unsigned long * TranspositionTable::getCounters()
+{
+	unsigned int t = omp_get_thread_num();
+	return &counters[(t % nThreads) * BUCKETSIZE];
+}
+
+/**
+ * Checks whether there is an entry for 'conf' with a depth <= 'newDepth'. If so, return
+ * 'false', else set the depth of 'conf' to 'newDepth' and return 'true'. If there is no
+ * entry and the bucket of 'conf' is full, the entry with the largest depth is replaced,
+ * since it prunes the smallest part of the search tree. The old depth (0, if there was no
+ * entry) is returned in '*old'. This method is thread-safe and lock-free.
+ */
+bool TranspositionTable::lookup_and_set(confno_t conf, unsigned int newDepth,
+										unsigned char * old)
+{
+	unsigned long h = hashConfNo(conf);
+	volatile unsigned long * bucket = &table[(h & ((1UL << indexBits) - 1)) * BUCKETSIZE];
+	unsigned long tag = h >> indexBits;
+	unsigned long entry = (tag << 8) | newDepth;
+	unsigned long * cnt = getCounters();
+
+	for (;;) {
+		// Search the configuration in the bucket, and the entry to be replaced otherwise:
+		// an empty entry, or the one with the largest depth.
+		unsigned int victim = 0;
+		unsigned long victimValue = bucket[0];
+		unsigned int i;
+		for (i=0; i<BUCKETSIZE; i++) {
+			unsigned long value = bucket[i];
+			if ((value != 0) && ((value >> 8) == tag)) {
+				// If there is an entry with equal or smaller depth: we are done
+				if ((value & 255) <= newDepth) {
+					cnt[HIT]++;
+					return false;
+				}
+				if (__sync_bool_compare_and_swap(&bucket[i], value, entry)) {
+					cnt[MISS]++;
+					*old = value & 255;
+					return true;
+				}
+				break;
+			}
+			if ((victimValue != 0) && ((value == 0) || ((value & 255) > (victimValue & 255)))) {
+				victim = i;
+				victimValue = value;
+			}
+		}
+		if (i < BUCKETSIZE)
+			continue;   // the entry of 'conf' has been changed by another thread: retry
+
+		// Not found: insert the configuration. If another thread has changed the entry in
+		// the meantime (maybe inserting 'conf'), search again.
+		if (__sync_bool_compare_and_swap(&bucket[victim], victimValue, entry)) {
+			cnt[MISS]++;
+			if (victimValue != 0)
+				cnt[REPLACE]++;
+			*old = 0;
+			return true;
+		}
+	}
+}
+
+/**
+ * Return the depth stored for 'conf', or 0 if there is no entry.
+ */
+unsigned int TranspositionTable::get(confno_t conf)
+{
+	unsigned long h = hashConfNo(conf);
+	volatile unsigned long * bucket = &table[(h & ((1UL << indexBits) - 1)) * BUCKETSIZE];
+	unsigned long tag = h >> indexBits;
+	for (unsigned int i=0; i<BUCKETSIZE; i++) {
+		unsigned long value = bucket[i];
+		if ((value != 0) && ((value >> 8) == tag))
+			return value & 255;
+	}
+	return 0;
+}
+
+/**
+ * Return the number of KBytes used by the table.
+ */
+unsigned long TranspositionTable::memory()
+{
+	return (BUCKETSIZE << indexBits) * sizeof(unsigned long) / 1024;
+}
+
+/**
+ * Print the number of hits, misses and replacements.
+ */
+void TranspositionTable::statistics()
+{
+	unsigned long sum[NCOUNTERS] = { 0 };
+	for (unsigned int t=0; t<nThreads; t++) {
+		for (unsigned int c=0; c<NCOUNTERS; c++)
+			sum[c] += counters[t*BUCKETSIZE + c];
+	}
+	cout << "Transposition table: " << sum[HIT] << " hits, " << sum[MISS] << " misses, "
+		 << sum[REPLACE] << " replacements\n";
+}
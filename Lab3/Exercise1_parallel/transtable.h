@@ -0,0 +1,69 @@
+using namespace std;
+
+/**
+ * Transposition table for the depth first search: a hash table of fixed size, which maps a
+ * configuration number to the lowest depth found so far. In contrast to the two-level array
+ * of DFSDepthMap, the memory does not depend on the range of configuration numbers, but is
+ * given by the user. If the table is full, entries are replaced, so a configuration may be
+ * examined more than once (but never missed).
+ * The table consists of buckets of BUCKETSIZE entries (one cache line). Each entry is a single
+ * 64-bit word containing the depth in the lowest 8 bits and the configuration's hash value
+ * without the bits used as bucket index. Since hashConfNo() is a bijection on 64-bit numbers,
+ * this identifies the configuration exactly (with WIDE, two configurations with the same
+ * 64-bit hash value can not be distinguished, which is very unlikely). Thus, all entries
+ * can be changed with an atomic compare-and-swap, and no locks are needed.
+ */
+class TranspositionTable
+{
+ private:
+	// Number of entries per bucket (64 bytes)
+	static const unsigned int BUCKETSIZE = 8;
+
+	// The buckets, and the number of bits of the bucket index (at least 8, so the remaining
+	// bits of the hash value fit into an entry together with the depth)
+	volatile unsigned long * table;
+	unsigned int indexBits;
+
+	// Statistics of lookups: each thread counts in its own row (a cache line) of 'counters'
+	enum Counter { HIT, MISS, REPLACE, NCOUNTERS };
+	unsigned long * counters;
+	unsigned int nThreads;
+
+	// Return the row of counters of the calling thread.
+	unsigned long * getCounters();
+
+ public:
+	/**
+	 * Constructor: Creates an empty table using (at most) 'mBytes' MBytes.
+	 */
+	TranspositionTable(unsigned long mBytes);
+
+	/**
+	 * Destructor: deallocate memory.
+	 */
+	~TranspositionTable();
+
+	/**
+	 * Checks whether there is an entry for 'conf' with a depth <= 'newDepth'. If so, return
+	 * 'false', else set the depth of 'conf' to 'newDepth' and return 'true'. If there is no
+	 * entry and the bucket of 'conf' is full, the entry with the largest depth is replaced,
+	 * since it prunes the smallest part of the search tree. The old depth (0, if there was no
+	 * entry) is returned in '*old'. This method is thread-safe and lock-free.
+	 */
+	bool lookup_and_set(confno_t conf, unsigned int newDepth, unsigned char * old);
+
+	/**
+	 * Return the depth stored for 'conf', or 0 if there is no entry.
+	 */
+	unsigned int get(confno_t conf);
+
+	/**
+	 * Return the number of KBytes used by the table.
+	 */
+	unsigned long memory();
+
+	/**
+	 * Print the number of hits, misses and replacements.
+	 */
+	void statistics();
+};
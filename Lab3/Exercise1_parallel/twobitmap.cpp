@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <iostream>
+
+#include "confno.h"
+#include "confighashmap.h"
+#include "historyfile.h"
+#include "twobitmap.h"
+
+using namespace std;
+
+/**
+ * State of all configurations for a layered breadth first search, using just two bits per
+ * configuration.
+ */
+
+
+/**
+ * Constructor: Creates a map for configuration numbers between 0 and numConf-1, where
+ * all configurations are UNSEEN.
+ */
+TwoBitMap::TwoBitMap(confno_t numConf)
+{
+	// In contrast to the other classes, the array is not allocated on demand, so it must
+	// fit into the main memory.
+	if (!ConfigHashMap::fitsDense(numConf / 4)) {
+		cerr << "Error: too many configurations for the two-bit search!\n";
+		exit(1);
+	}
+	numWords = index(numConf - 1) + 1;
+	states = new unsigned long[numWords]();
+	current = 1;
+	next = 2;
+}
+
+/**
+ * Destructor: deallocate memory.
+ */
+TwoBitMap::~TwoBitMap()
+{
+	delete[] states;
+}
+
+/**
+ * Set all configurations to UNSEEN, and 'conf' to the current tree depth.
+ */
+void TwoBitMap::reset(confno_t conf)
+{
+	memset((void *)states, 0, numWords * sizeof(unsigned long));
+	current = 1;
+	next = 2;
+	states[index(conf)] = (unsigned long)current << shift(conf);
+}
+
+/**
+ * Determine all configurations of the current tree depth in the word 'w' of the array,
+ * store their numbers in 'confs' and mark them as CLOSED. Returns the number of
+ * configurations found (at most WORDSIZE). This method is thread-safe.
+ */
+unsigned int TwoBitMap::getCurrent(unsigned long w, confno_t confs[])
+{
+	unsigned long word = states[w];
+	if (word == 0)
+		return 0;
+
+	// Determine the states equal to 'current': for each state, the low bit of 'match' is
+	// set iff both bits of the state are equal to those of 'current'.
+	const unsigned long LOW = 0x5555555555555555UL;
+	unsigned long pattern = (current == 1) ? LOW : (LOW << 1);
+	unsigned long diff = word ^ pattern;
+	unsigned long match = ~(diff | (diff >> 1)) & LOW;
+	if (match == 0)
+		return 0;
+
+	// Other threads may only change UNSEEN states concurrently, so the configurations found
+	// can be closed with an atomic or.
+	__sync_fetch_and_or(&states[w], match * 3);
+
+	unsigned int n = 0;
+	confno_t base = (confno_t)w * WORDSIZE;
+	while (match != 0) {
+		unsigned int bit = __builtin_ctzl(match);
+		confs[n++] = base + bit / 2;
+		match &= match - 1;
+	}
+	return n;
+}
+
+/**
+ * Checks whether 'conf' is UNSEEN. If so, set it to the next tree depth and return 'true',
+ * else return 'false'. This method is thread-safe and lock-free.
+ */
+bool TwoBitMap::add(confno_t conf)
+{
+	volatile unsigned long * p = &states[index(conf)];
+	unsigned int s = shift(conf);
+	unsigned long old = *p;
+	while (true) {
+		if (((old >> s) & 3) != UNSEEN)
+			return false;
+		unsigned long seen = __sync_val_compare_and_swap(p, old, old | ((unsigned long)next << s));
+		if (seen == old)
+			return true;
+		old = seen;
+	}
+}
+
+/**
+ * Advance to the next tree depth. There must not be any configurations of the current
+ * tree depth left.
+ */
+void TwoBitMap::pushDepth()
+{
+	unsigned int tmp = current;
+	current = next;
+	next = tmp;
+}
+
+/**
+ * Append a snapshot of the map (the states and the codes of the tree depths) to 'file'
+ * and return its position in the file.
+ */
+unsigned long TwoBitMap::save(HistoryFile * file)
+{
+	unsigned long offset = file->length();
+	unsigned long codes = current;
+	file->append(&codes, sizeof(unsigned long));
+	file->append((const void *)states, numWords * sizeof(unsigned long));
+	return offset;
+}
+
+/**
+ * Restore the map from the snapshot at position 'offset' of 'file' (see save()).
+ */
+void TwoBitMap::restore(HistoryFile * file, unsigned long offset)
+{
+	const unsigned long * data = (const unsigned long *)file->at(offset);
+	current = data[0];
+	next = 3 - current;
+	memcpy((void *)states, &data[1], numWords * sizeof(unsigned long));
+}
+
+/**
+ * Return the number of KBytes used by the map.
+ */
+unsigned long TwoBitMap::memory()
+{
+	return numWords * sizeof(unsigned long) / 1024;
+}
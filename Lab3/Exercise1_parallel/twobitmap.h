@@ -0,0 +1,108 @@
+using namespace std;
+
+/**
+ * State of all configurations for a layered breadth first search, using just two bits per
+ * configuration. Since the configuration numbers are dense, the states are stored in a single
+ * array indexed directly by the configuration number, and there is no queue at all: a tree
+ * depth is expanded by scanning the whole array for the configurations of the current depth.
+ * A configuration is either
+ *  - UNSEEN: not found yet,
+ *  - in the current tree depth, i.e., it still has to be expanded,
+ *  - in the next tree depth, i.e., it has been found while expanding the current depth, or
+ *  - CLOSED: it has been expanded.
+ * The codes for 'current' and 'next' are swapped when advancing to the next tree depth, so
+ * no additional pass over the array is necessary.
+ */
+class TwoBitMap
+{
+ private:
+	// Array with 32 states per word
+	volatile unsigned long * states;
+
+	// Number of words in 'states'
+	unsigned long numWords;
+
+	// Codes of the configurations in the current and the next tree depth (1 or 2)
+	unsigned int current;
+	unsigned int next;
+
+	inline unsigned long index(confno_t conf)  { return conf >> 5; }
+	inline unsigned int shift(confno_t conf)   { return (conf & 31) * 2; }
+
+ public:
+	static const unsigned int UNSEEN = 0;
+	static const unsigned int CLOSED = 3;
+
+	/**
+	 * Number of configurations per word, see getCurrent().
+	 */
+	static const unsigned int WORDSIZE = 32;
+
+	/**
+	 * Constructor: Creates a map for configuration numbers between 0 and numConf-1, where
+	 * all configurations are UNSEEN.
+	 */
+	TwoBitMap(confno_t numConf);
+
+	/**
+	 * Destructor: deallocate memory.
+	 */
+	~TwoBitMap();
+
+	/**
+	 * Set all configurations to UNSEEN, and 'conf' to the current tree depth.
+	 */
+	void reset(confno_t conf);
+
+	/**
+	 * Return the number of words of the array, which are scanned with getCurrent().
+	 */
+	inline unsigned long words()
+	{
+		return numWords;
+	}
+
+	/**
+	 * Determine all configurations of the current tree depth in the word 'w' of the array,
+	 * store their numbers in 'confs' and mark them as CLOSED. Returns the number of
+	 * configurations found (at most WORDSIZE). This method is thread-safe.
+	 */
+	unsigned int getCurrent(unsigned long w, confno_t confs[]);
+
+	/**
+	 * Checks whether 'conf' is UNSEEN. If so, set it to the next tree depth and return 'true',
+	 * else return 'false'. This method is thread-safe and lock-free.
+	 */
+	bool add(confno_t conf);
+
+	/**
+	 * Advance to the next tree depth. There must not be any configurations of the current
+	 * tree depth left.
+	 */
+	void pushDepth();
+
+	/**
+	 * Append a snapshot of the map (the states and the codes of the tree depths) to 'file'
+	 * and return its position in the file.
+	 */
+	unsigned long save(HistoryFile * file);
+
+	/**
+	 * Restore the map from the snapshot at position 'offset' of 'file' (see save()).
+	 */
+	void restore(HistoryFile * file, unsigned long offset);
+
+	/**
+	 * Return the state of 'conf'. Apart from UNSEEN and CLOSED, this may be the code of the
+	 * current or the next tree depth.
+	 */
+	inline unsigned int get(confno_t conf)
+	{
+		return (states[index(conf)] >> shift(conf)) & 3;
+	}
+
+	/**
+	 * Return the number of KBytes used by the map.
+	 */
+	unsigned long memory();
+};
@@ -0,0 +1,87 @@
+#include <vector>
+
+#include "confno.h"
+#include "workdeque.h"
+
+using namespace std;
+
+
+/**
+ * Constructor: Creates an empty deque.
+ */
+WorkDeque::WorkDeque()
+{
+	lock = 0;
+	head = 0;
+	count = 0;
+}
+
+void WorkDeque::acquire()
+{
+	while (__sync_lock_test_and_set(&lock, 1) != 0) {
+		while (lock != 0)
+			;
+	}
+}
+
+void WorkDeque::release()
+{
+	__sync_lock_release(&lock);
+}
+
+/**
+ * Add the item 'item' at the bottom.
+ */
+void WorkDeque::push(const WorkItem & item)
+{
+	acquire();
+	items.push_back(item);
+	count++;
+	release();
+}
+
+/**
+ * Remove the item at the bottom and store it in '*item'. Returns false if the deque is
+ * empty.
+ */
+bool WorkDeque::pop(WorkItem * item)
+{
+	bool result = false;
+	acquire();
+	if (head < items.size()) {
+		*item = items.back();
+		items.pop_back();
+		count--;
+		result = true;
+	}
+	if (head == items.size()) {
+		items.clear();
+		head = 0;
+	}
+	release();
+	return result;
+}
+
+/**
+ * Remove the item at the top and store it in '*item'. Returns false if the deque is
+ * empty.
+ */
+bool WorkDeque::steal(WorkItem * item)
+{
+	// Plain read first, so idle threads do not disturb the owner by taking the lock
+	if (count == 0)
+		return false;
+	bool result = false;
+	acquire();
+	if (head < items.size()) {
+		*item = items[head++];
+		count--;
+		result = true;
+	}
+	if (head == items.size()) {
+		items.clear();
+		head = 0;
+	}
+	release();
+	return result;
+}
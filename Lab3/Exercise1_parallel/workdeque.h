@@ -0,0 +1,64 @@
+using namespace std;
+
+/**
+ * Work item of the work-stealing depth first search: a configuration near the root of the
+ * search tree, given by the path from the initial configuration to it. Since work items are
+ * only created up to a depth of MAXDEPTH, an item has a small fixed size.
+ */
+struct WorkItem
+{
+	static const unsigned int MAXDEPTH = 8;
+
+	confno_t path[MAXDEPTH];    // path[depth-1] is the configuration of this item
+	unsigned char depth;        // Length of the path
+	unsigned char lastBox;      // Number of the box that was moved last
+};
+
+/**
+ * Double-ended queue of work items for the work-stealing depth first search. Each thread
+ * owns one deque: it adds and removes its own items at the bottom (so it works depth first),
+ * while other threads steal items from the top, i.e., the items closest to the root of the
+ * search tree, which usually have the largest subtrees. Each deque is protected by a spin
+ * lock; since a thread mostly accesses its own deque, there is hardly any contention.
+ * The deques are aligned to cache lines, so the locks of different threads do not share a
+ * line.
+ */
+class alignas(64) WorkDeque
+{
+ private:
+	// Spin lock (0 = free)
+	volatile int lock;
+
+	// The items; the deque consists of the entries items[head] ... items[items.size()-1]
+	vector<WorkItem> items;
+	unsigned long head;
+
+	// Number of items in the deque (can be read without the lock)
+	volatile unsigned long count;
+
+	void acquire();
+	void release();
+
+ public:
+	/**
+	 * Constructor: Creates an empty deque.
+	 */
+	WorkDeque();
+
+	/**
+	 * Add the item 'item' at the bottom.
+	 */
+	void push(const WorkItem & item);
+
+	/**
+	 * Remove the item at the bottom and store it in '*item'. Returns false if the deque is
+	 * empty.
+	 */
+	bool pop(WorkItem * item);
+
+	/**
+	 * Remove the item at the top and store it in '*item'. Returns false if the deque is
+	 * empty.
+	 */
+	bool steal(WorkItem * item);
+};